@@ -15,13 +15,21 @@ HEADERS += \
     src/SvgNest/nestingWorker.h \
     src/SvgNest/placementTypes.h \
     src/Core/nestingEngine.h \
+    src/Core/feasibleRegion.h \
+    src/Core/placementTrie.h \
+    src/Core/obstacleUnion.h \
     src/Core/geneticAlgorithm.h \
     src/Core/internalTypes.h \
     src/Geometry/SimplifyPath.h \
     src/Geometry/HullPolygon.h \
+    src/Geometry/minkowskiQuads.h \
+    src/Geometry/batchPointInPolygon.h \
     src/Geometry/geometryUtils.h \
     src/Geometry/nfpGenerator.h \
-    src/Geometry/nfpCache.h
+    src/Geometry/nfpCache.h \
+    src/Geometry/nfpDiskStore.h \
+    src/Geometry/nfpStats.h \
+    src/Geometry/orbitalNfp.h
 
 # Specify source files
 SOURCES += \
@@ -29,13 +37,21 @@ SOURCES += \
     src/SvgNest/nestingWorker.cpp \
     src/SvgNest/placementTypes.cpp \
     src/Core/nestingEngine.cpp \
+    src/Core/feasibleRegion.cpp \
+    src/Core/placementTrie.cpp \
+    src/Core/obstacleUnion.cpp \
     src/Core/geneticAlgorithm.cpp \
     src/Core/internalTypes.cpp \
     src/Geometry/SimplifyPath.cpp \
     src/Geometry/HullPolygon.cpp \
+    src/Geometry/minkowskiQuads.cpp \
+    src/Geometry/batchPointInPolygon.cpp \
     src/Geometry/geometryUtils.cpp \
     src/Geometry/nfpGenerator.cpp \
-    src/Geometry/nfpCache.cpp
+    src/Geometry/nfpCache.cpp \
+    src/Geometry/nfpDiskStore.cpp \
+    src/Geometry/nfpStats.cpp \
+    src/Geometry/orbitalNfp.cpp
 
 # Include paths
 INCLUDEPATH += ../../boost \
@@ -57,13 +73,20 @@ SOURCES += \
     # otherwise, if it's header-only, it's fine.
 
 SOURCES += \
-    src/External/Minkowski/minkowski_wrapper.cpp
-
-    #src/External/Minkowski/minkowski_thread_wrapper.cpp
+    src/External/Minkowski/minkowski_wrapper.cpp \
+    src/External/Minkowski/minkowski_thread_wrapper.cpp
 
 # Make sure headers from Clipper2Lib are accessible
 INCLUDEPATH += $$CLIPPER2_SRC_DIR
 
+# Opt-in AVX2 kernels for the Minkowski edge-pair quads (src/Geometry/minkowskiQuads.cpp) and the
+# batched point-in-polygon test (src/Geometry/batchPointInPolygon.cpp): qmake CONFIG+=simd_avx2.
+# ARM builds use NEON for the quads without any flag; otherwise the kernels are plain C++.
+simd_avx2 {
+    msvc: QMAKE_CXXFLAGS += /arch:AVX2
+    else: QMAKE_CXXFLAGS += -mavx2
+}
+
 # For building a shared library (DLL/SO)
 CONFIG += staticlib
 
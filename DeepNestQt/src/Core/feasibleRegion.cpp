@@ -0,0 +1,69 @@
+#include "feasibleRegion.h"
+#include "batchPointInPolygon.h" // For Geometry::BatchPointInPolygon
+#include <algorithm> // For std::minmax_element
+
+namespace Core {
+
+void FeasibleRegion::setContainer(const Geometry::NfpHandle& innerNfp) {
+    if (innerNfp.data() == container_.data()) return; // Same part on the same sheet as the last step
+    container_ = innerNfp;
+    containerData_.Clear();
+    containerArea_.clear();
+    containerSegments_.clear();
+    containerPoints_.clear();
+    if (container_.isNull()) return;
+
+    for (const Clipper2Lib::Path64& ring : container_->paths) {
+        if (ring.empty()) continue;
+        if (Clipper2Lib::Area(ring) != 0) {
+            containerArea_.push_back(ring);
+            continue;
+        }
+        // A zero-area ring is a straight run of positions (a part exactly as wide or tall as the
+        // room it has) or a single position; Clipper2 would drop it as a closed path.
+        const auto extremes = std::minmax_element(ring.begin(), ring.end(),
+            [](const Clipper2Lib::Point64& a, const Clipper2Lib::Point64& b) {
+                return a.x < b.x || (a.x == b.x && a.y < b.y);
+            });
+        if (*extremes.first == *extremes.second) {
+            containerPoints_.push_back(*extremes.first);
+        } else {
+            containerSegments_.push_back(Clipper2Lib::Path64{*extremes.first, *extremes.second});
+        }
+    }
+    containerData_.AddPaths(containerArea_, Clipper2Lib::PathType::Subject, false);
+    containerData_.AddPaths(containerSegments_, Clipper2Lib::PathType::Subject, true);
+}
+
+void FeasibleRegion::compute(const Clipper2Lib::Paths64& obstacles) {
+    region_.clear();
+    segments_.clear();
+    if (obstacles.empty()) {
+        region_ = containerArea_;
+        segments_ = containerSegments_;
+        for (const Clipper2Lib::Point64& point : containerPoints_) segments_.push_back(Clipper2Lib::Path64{point});
+        return;
+    }
+
+    if (!containerArea_.empty() || !containerSegments_.empty()) {
+        // Subtracting all clip paths at once under NonZero subtracts their union.
+        clipper_.Clear();
+        clipper_.AddReuseableData(containerData_);
+        clipper_.AddClip(obstacles);
+        clipper_.Execute(Clipper2Lib::ClipType::Difference, Clipper2Lib::FillRule::NonZero, region_, segments_);
+    }
+
+    // Single positions have nothing to clip; they are feasible unless strictly inside the union of
+    // the obstacles. The rings may overlap: a point on one of them but inside another is covered.
+    if (!containerPoints_.empty()) {
+        std::vector<Clipper2Lib::PointInPolygonResult> locations;
+        Geometry::BatchPointInPolygon(obstacles).locate(containerPoints_, Clipper2Lib::FillRule::NonZero, locations);
+        for (size_t i = 0; i < containerPoints_.size(); ++i) {
+            if (locations[i] != Clipper2Lib::PointInPolygonResult::IsInside) {
+                segments_.push_back(Clipper2Lib::Path64{containerPoints_[i]});
+            }
+        }
+    }
+}
+
+} // namespace Core
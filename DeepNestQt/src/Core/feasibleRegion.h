@@ -0,0 +1,41 @@
+#ifndef FEASIBLEREGION_H
+#define FEASIBLEREGION_H
+
+#include "nfpCache.h" // For Geometry::NfpHandle
+#include "Clipper2/clipper.h" // For Clipper2Lib::Clipper64, Clipper2Lib::ReuseableDataContainer64
+
+namespace Core {
+
+// Placement stage of one fitness evaluation: the positions of a part's reference point that lie in
+// the inner NFP (inside the sheet) and outside every obstacle NFP (clear of the placed parts),
+// touching allowed. As in DeepNest, the union of the obstacle NFPs is subtracted from the inner NFP
+// in a single Clipper64 execution; the candidate positions are the vertices of the result.
+// The inner NFP is kept as reusable Clipper2 data while consecutive steps place the same part on
+// the same sheet. Not thread-safe, each evaluation owns its stage.
+class FeasibleRegion {
+public:
+    // Makes 'innerNfp' the region the obstacles are subtracted from. Exact fits in the inner NFP
+    // (zero-area rings) are kept apart as open segments and single points.
+    void setContainer(const Geometry::NfpHandle& innerNfp);
+    // Inner NFP minus 'obstacles': the obstacle NFPs translated to the placed parts, or their union
+    // (SheetPlacementState::obstacleUnions). Both are read with a NonZero fill.
+    void compute(const Clipper2Lib::Paths64& obstacles);
+
+    // Feasible area, rings with holes (NonZero).
+    const Clipper2Lib::Paths64& region() const { return region_; }
+    // Feasible exact-fit positions: open paths (two or more points) and single points.
+    const Clipper2Lib::Paths64& segments() const { return segments_; }
+
+private:
+    Geometry::NfpHandle container_;
+    Clipper2Lib::ReuseableDataContainer64 containerData_; // containerArea_ and containerSegments_ as subjects
+    Clipper2Lib::Paths64 containerArea_;     // Rings of container_ with an area
+    Clipper2Lib::Paths64 containerSegments_; // Zero-area rings of container_ reduced to their end points
+    Clipper2Lib::Path64 containerPoints_;    // Zero-area rings of container_ that are a single point
+    Clipper2Lib::Clipper64 clipper_;
+    Clipper2Lib::Paths64 region_;
+    Clipper2Lib::Paths64 segments_;
+};
+
+} // namespace Core
+#endif // FEASIBLEREGION_H
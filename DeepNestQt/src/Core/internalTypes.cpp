@@ -1,14 +1,30 @@
 #include "internalTypes.h"
-// No specific code needed yet if header only contains type definitions
+#include "geometryUtils.h" // For GeometryUtils::toPath64, GeometryUtils::convexDecomposition
 
 
 namespace Core {
 
 InternalPart::InternalPart(const InternalSheet& part )
-    : outerBoundary(part.outerBoundary), holes(part.holes) {
+    : id(part.id), outerBoundary(part.outerBoundary), holes(part.holes),
+      cacheIndex(part.cacheIndex), fingerprint(part.fingerprint), isConvex(part.isConvex),
+      outerPath64(part.outerPath64), holesPath64(part.holesPath64) {
     if (!outerBoundary.isEmpty()) {
         bounds = outerBoundary.boundingRect();
     }
 }
 
+void InternalPart::buildPath64(double scale) {
+    outerPath64 = GeometryUtils::toPath64(outerBoundary, scale);
+    holesPath64 = GeometryUtils::toPaths64(holes, scale);
+}
+
+void InternalPart::buildConvexPieces() {
+    convexPieces = isConvex ? Clipper2Lib::Paths64{outerPath64} : GeometryUtils::convexDecomposition(outerPath64);
+}
+
+void InternalSheet::buildPath64(double scale) {
+    outerPath64 = GeometryUtils::toPath64(outerBoundary, scale);
+    holesPath64 = GeometryUtils::toPaths64(holes, scale);
+}
+
 }
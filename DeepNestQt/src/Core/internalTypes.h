@@ -5,6 +5,7 @@
 #include <QList>
 #include <QString>
 #include <QRectF> // For bounding box
+#include "Clipper2/clipper.h" // For Clipper2Lib::Path64
 
 namespace Core {
 
@@ -29,6 +30,15 @@ struct InternalPart {
 
     // Optional: Pre-calculated properties
     QRectF bounds;              // Bounding box of the outerBoundary
+    int cacheIndex = -1;        // Interned index identifying this part in NFP cache keys (assigned by NestingEngine)
+    quint64 fingerprint = 0;    // Canonical geometry fingerprint (see GeometryUtils::geometryFingerprint), 0 = not computed
+    bool isConvex = false;      // Outer boundary is convex (set in preprocessing); rotations keep it
+
+    // Fixed-point copies of the geometry at Configuration::clipperScale, used by all NFP computations.
+    Clipper2Lib::Path64 outerPath64;
+    Clipper2Lib::Paths64 holesPath64;
+    // Convex pieces of outerPath64, only built for the decomposition NFP backend (see buildConvexPieces).
+    Clipper2Lib::Paths64 convexPieces;
 
     // Constructor
     InternalPart(QString p_id = "", QPolygonF p_outer = QPolygonF(), QList<QPolygonF> p_holes = QList<QPolygonF>())
@@ -41,6 +51,11 @@ struct InternalPart {
     InternalPart(const InternalSheet& sheet);
 
     bool isValid() const { return !outerBoundary.isEmpty(); }
+
+    // Converts the double geometry to outerPath64/holesPath64 (done once in preprocessing).
+    void buildPath64(double scale);
+    // Decomposes outerPath64 into convexPieces (GeometryUtils::convexDecomposition); call after buildPath64.
+    void buildConvexPieces();
 };
 
 // Represents the sheet material
@@ -50,6 +65,12 @@ struct InternalSheet {
     QList<QPolygonF> holes; // Sheets can also have holes/cutouts
 
     QRectF bounds;
+    int cacheIndex = -1;    // Interned index identifying this sheet in NFP cache keys (assigned by NestingEngine)
+    quint64 fingerprint = 0;  // Canonical geometry fingerprint, 0 = not computed
+    bool isConvex = false;    // Outer boundary is convex
+
+    Clipper2Lib::Path64 outerPath64;  // Fixed-point geometry at Configuration::clipperScale
+    Clipper2Lib::Paths64 holesPath64;
 
     InternalSheet(QPolygonF p_outer = QPolygonF(), QList<QPolygonF> p_holes = QList<QPolygonF>())
         : outerBoundary(p_outer), holes(p_holes) {
@@ -59,8 +80,12 @@ struct InternalSheet {
     }
      bool isValid() const { return !outerBoundary.isEmpty(); }
 
+    void buildPath64(double scale);
+
     InternalSheet(const InternalPart& part )
-        : outerBoundary(part.outerBoundary), holes(part.holes) {
+        : id(part.id), outerBoundary(part.outerBoundary), holes(part.holes),
+          cacheIndex(part.cacheIndex), fingerprint(part.fingerprint), isConvex(part.isConvex),
+          outerPath64(part.outerPath64), holesPath64(part.holesPath64) {
         if (!outerBoundary.isEmpty()) {
             bounds = outerBoundary.boundingRect();
         }
@@ -8,6 +8,13 @@
 #include <QFutureWatcher> // Useful for handling results, but can also use QFuture::results()
 #include <QThreadPool>    // To potentially control max thread count
 #include <QElapsedTimer>  // For basic performance timing
+#include <QSet>
+#include <QJsonDocument>
+
+// Share of the overall progress taken by the NFP precomputation stage
+const int PRECOMPUTE_PROGRESS_SHARE = 20;
+// NFPs a precomputation thread claims at a time; the cache budget is checked between batches
+const int PRECOMPUTE_BATCH_SIZE = 16;
 
 // Define a high value for "not placed" or error fitness
 const double BAD_FITNESS_SCORE = -std::numeric_limits<double>::infinity(); // If higher is better
@@ -16,6 +23,16 @@ const double BAD_FITNESS_SCORE = -std::numeric_limits<double>::infinity(); // If
 
 namespace Core {
 
+// One NFP to compute in the precomputation stage.
+struct NfpPrecomputeTask {
+    const InternalPart* part;       // Orbiting (or fitting) part
+    const InternalPart* obstacle;   // Static part for outer NFPs, nullptr for inner NFPs
+    const InternalSheet* sheet;     // Container for inner NFPs
+    double rotation;                // Rotation of 'part'
+    double obstacleRotation;        // Rotation of 'obstacle'
+    qint64 cost;                    // Estimated work, used to schedule large pairs first
+};
+
 // Structure to hold result of fitness calculation for QtConcurrent::mapped
 struct FitnessResult {
     double fitness = BAD_FITNESS_SCORE; // Initialize to bad fitness
@@ -26,17 +43,77 @@ struct FitnessResult {
 };
 
 
+// The "deepnest" placement keeps its original NFP module; otherwise Configuration::nfpBackend decides.
+static Geometry::NfpBackend selectNfpBackend(const SvgNest::Configuration& config) {
+    if (config.placementType == "deepnest") return Geometry::NfpBackend::CustomMinkowski;
+    const Geometry::NfpBackend backend = Geometry::nfpBackendFromName(config.nfpBackend, Geometry::NfpBackend::Clipper2);
+    if (backend != Geometry::NfpBackend::Clipper2 && backend != Geometry::NfpBackend::Decomposition &&
+        backend != Geometry::NfpBackend::Orbital) {
+        qWarning() << "NestingEngine: Unsupported NFP backend" << config.nfpBackend << "- using clipper2.";
+        return Geometry::NfpBackend::Clipper2;
+    }
+    return backend;
+}
+
+// Disk-store profile: the NFP backend in use, and for the orbital backend whether it explored
+// concavities, since that changes the NFPs it produces.
+static quint32 nfpDiskProfile(Geometry::NfpBackend backend, bool exploreConcave) {
+    const quint32 profile = static_cast<quint32>(backend) + 1;
+    return backend == Geometry::NfpBackend::Orbital && exploreConcave ? profile | 0x100 : profile;
+}
+
+// NFPs queued for the disk store stay in memory until written, so with a cache budget the queue
+// is kept to a fraction of it.
+static qint64 nfpDiskPendingBytes(qint64 cacheBudget) {
+    const qint64 limit = Geometry::NfpDiskStore::kDefaultMaxPendingBytes;
+    return cacheBudget > 0 ? qBound<qint64>(1, cacheBudget / 8, limit) : limit;
+}
+
 NestingEngine::NestingEngine(const SvgNest::Configuration& config,
                              QList<InternalPart>& partsToPlace,
                              const QList<InternalSheet>& sheets)
     : config_(config),
       allParts_(partsToPlace), // Store reference
       sheets_(sheets),
+      nfpBackend_(selectNfpBackend(config)),
+      nfpCache_(config.nfpCacheShards, config.nfpCacheMemoryBudget), // Sharded so evaluator threads rarely share a lock
+      nfpDiskStore_(config.nfpCacheDirectory, nfpDiskProfile(nfpBackend_, config.exploreConcave), config.clipperScale,
+                    nfpDiskPendingBytes(config.nfpCacheMemoryBudget)),
       nfpGenerator_(config.clipperScale), // Initialize NfpGenerator with scale
       geneticAlgorithm_(config, allParts_), // Pass all available part instances
+      placementTrie_(config.placementCheckpointMemoryBudget),
       stopRequested_(false),
       solutionsFoundCount_(0) {
-    qDebug() << "NestingEngine created. Parts to place:" << allParts_.size() << "Sheets available:" << sheets_.size();
+    nfpGenerator_.setStats(&nfpCache_.stats());
+    nfpGenerator_.setExploreConcave(config.exploreConcave);
+
+    // Intern part and sheet identities once, so NFP cache keys are built from plain integers.
+    // Shapes are identified by their geometry fingerprint, so parts with different IDs but the
+    // same outline share their NFPs; the ID is only the fallback for unfingerprinted geometry.
+    QHash<quint64, int> shapeIndices;
+    QHash<QString, int> idIndices;
+    int nextCacheIndex = 0;
+    auto internShape = [&](quint64 fingerprint, const QString& id) -> int {
+        if (fingerprint != 0) {
+            auto it = shapeIndices.find(fingerprint);
+            if (it == shapeIndices.end()) it = shapeIndices.insert(fingerprint, nextCacheIndex++);
+            return it.value();
+        }
+        auto it = idIndices.find(id);
+        if (it == idIndices.end()) it = idIndices.insert(id, nextCacheIndex++);
+        return it.value();
+    };
+    for (InternalPart& part : allParts_) {
+        part.cacheIndex = internShape(part.fingerprint, part.id);
+    }
+    const int partShapes = nextCacheIndex;
+    for (InternalSheet& sheet : sheets_) {
+        sheet.cacheIndex = internShape(sheet.fingerprint, sheet.id);
+    }
+    qDebug() << "NestingEngine created. Parts to place:" << allParts_.size() << "Sheets available:" << sheets_.size()
+             << "Distinct part shapes:" << partShapes
+             << "NFP cache shards:" << nfpCache_.shardCount()
+             << "budget (bytes):" << config_.nfpCacheMemoryBudget;
     // You can adjust the global QThreadPool if needed:
     // QThreadPool::globalInstance()->setMaxThreadCount(desired_max_threads);
 }
@@ -59,6 +136,12 @@ QList<SvgNest::NestSolution> NestingEngine::runNesting() {
     }
 
     geneticAlgorithm_.initializePopulation();
+    placementTrie_.clear();
+
+    const int precomputeShare = config_.precomputeNfps ? PRECOMPUTE_PROGRESS_SHARE : 0;
+    if (config_.precomputeNfps) {
+        precomputeNfps(precomputeShare);
+    }
 
     int maxGenerations = config_.populationSize * 10; 
     if (config_.placementType == "simple") maxGenerations = 1;
@@ -69,6 +152,7 @@ QList<SvgNest::NestSolution> NestingEngine::runNesting() {
             break;
         }
         qDebug() << "NestingEngine: GA Generation" << gen;
+        placementTrie_.beginGeneration(gen);
 
         QVector<Individual>& currentPopulation = const_cast<QVector<Individual>&>(geneticAlgorithm_.getPopulation());
         
@@ -128,6 +212,7 @@ QList<SvgNest::NestSolution> NestingEngine::runNesting() {
         if (stopRequested_) break;
 
         geneticAlgorithm_.runGeneration(); 
+        reportProgress(precomputeShare + (99 - precomputeShare) * (gen + 1) / maxGenerations);
         
         // Optionally, log or store the best solution of this generation
         Individual bestThisGen = geneticAlgorithm_.getBestIndividual();
@@ -138,7 +223,14 @@ QList<SvgNest::NestSolution> NestingEngine::runNesting() {
         }
     }
     
-    qDebug() << "NestingEngine: Nesting process finished. Total valid solutions considered:" << solutionsFoundCount_;
+    if (!nfpDiskStore_.flush()) {
+        qWarning() << "NestingEngine: Could not write new NFPs to" << config_.nfpCacheDirectory;
+    }
+
+    qDebug() << "NestingEngine: Nesting process finished. Total valid solutions considered:" << solutionsFoundCount_
+             << "Cached placement prefixes:" << placementTrie_.stateCount()
+             << "bytes:" << placementTrie_.memoryUsage();
+    qInfo().noquote() << "NestingEngine: NFP statistics:" << QJsonDocument(nfpStatistics()).toJson(QJsonDocument::Compact);
     qDebug() << "NestingEngine: Total time:" << timer.elapsed() << "ms";
     
     // Sort all collected solutions by fitness (descending, higher is better)
@@ -153,71 +245,70 @@ QList<SvgNest::NestSolution> NestingEngine::runNesting() {
 
 // calculateFitness remains largely the same, but must be thread-safe regarding
 // NestingEngine members if it accesses them.
-// NfpCache is now mutex-protected. Other shared state? allParts_ and sheets_ are read-only here.
+// NfpCache is sharded and lock-protected. Other shared state? allParts_ and sheets_ are read-only here.
 // config_ is read-only. stopRequested_ is an atomic or needs protection if written by another thread.
 // For now, stopRequested_ is checked by the lambda.
 double NestingEngine::calculateFitness(Individual& individual, SvgNest::NestSolution& outSolution) {
     outSolution.placements.clear();
-    QList<SvgNest::PlacedPart> placedPartsList;
-    int successfullyPlacedCount = 0;
+    const QVector<Gene>& chromosome = individual.chromosome;
     
     // Create a temporary, modifiable copy of parts for this individual's evaluation if needed
     // QList<InternalPart> partsForThisRun = allParts_; // If parts state changes during placement
 
-    // Map to keep track of placed parts on sheets for obstacle NFP calculations
-    QHash<int, QList<InternalPart>> partsOnSheetMap;
+    // Placements so far, and the placed parts (with their obstacle NFP unions) per sheet for the
+    // subsequent placements. Resumed from the longest prefix another evaluation already placed.
+    PlacementState state;
+    int firstGene = 0;
+    const int checkpointInterval = config_.placementCheckpointInterval;
+    if (checkpointInterval > 0) {
+        PlacementStateHandle resumed;
+        firstGene = placementTrie_.findLongestPrefix(chromosome, resumed);
+        if (!resumed.isNull()) state = *resumed;
+    }
+    // Reused by every placement step of this evaluation (evaluations run concurrently).
+    FeasibleRegion feasibleRegion;
 
 
-    for (const Gene& gene : individual.chromosome) {
+    for (int geneIndex = firstGene; geneIndex < chromosome.size(); ++geneIndex) {
         if (stopRequested_) return BAD_FITNESS_SCORE;
+        const Gene& gene = chromosome[geneIndex];
+        if (checkpointInterval > 0 && geneIndex > firstGene && geneIndex % checkpointInterval == 0) {
+            placementTrie_.insert(chromosome, geneIndex, PlacementStateHandle(new PlacementState(state)));
+        }
 
-        InternalPart partToPlaceOriginal;
-        bool foundPart = false;
+        const InternalPart* partToPlaceOriginal = nullptr;
         if(gene.sourceIndex >= 0 && gene.sourceIndex < allParts_.size() && allParts_[gene.sourceIndex].id == gene.partId) {
-             partToPlaceOriginal = allParts_[gene.sourceIndex];
-             foundPart = true;
+             partToPlaceOriginal = &allParts_[gene.sourceIndex];
         }
-        if(!foundPart) {
+        if(!partToPlaceOriginal) {
              qWarning() << "NestingEngine: Could not find valid part for gene ID" << gene.partId << "at sourceIndex" << gene.sourceIndex;
              continue;
         }
 
-        InternalPart partToPlaceTransformed = transformPart(partToPlaceOriginal, gene.rotation);
-        
         bool placedThisPart = false;
         for (int sheetIdx = 0; sheetIdx < sheets_.size(); ++sheetIdx) {
             if (stopRequested_) return BAD_FITNESS_SCORE;
             
-            const QList<InternalPart>& obstaclesOnThisSheet = partsOnSheetMap.value(sheetIdx);
+            SheetPlacementState& sheetState = state.sheets[sheetIdx];
 
             CandidatePosition bestPos = findBestPositionForPart(
-                partToPlaceTransformed, gene.rotation, sheets_[sheetIdx], obstaclesOnThisSheet, config_.placementType
+                *partToPlaceOriginal, gene.rotation, sheets_[sheetIdx], sheetState, config_.placementType,
+                feasibleRegion
             );
 
-            if (bestPos.position != QPointF(-1,-1)) { 
+            if (bestPos.sheetIndex >= 0) {
                 SvgNest::PlacedPart pp;
                 pp.partId = gene.partId; 
                 pp.sheetIndex = sheetIdx;
-                pp.position = bestPos.position;
+                // The only conversion back to floating point: the placement reported to the caller.
+                pp.position = GeometryUtils::fromPoint64(bestPos.position, config_.clipperScale);
                 pp.rotation = gene.rotation;
                 
-                placedPartsList.append(pp);
-                successfullyPlacedCount++;
+                state.placements.append(pp);
                 
-                // Add this part to the list of obstacles for the current sheet for subsequent placements
-                InternalPart placedPartCopy = partToPlaceTransformed; // It's already transformed
-                // Translate its geometry to the placed position to act as an obstacle
-                QTransform translateToPlace;
-                translateToPlace.translate(bestPos.position.x(), bestPos.position.y());
-                placedPartCopy.outerBoundary = translateToPlace.map(placedPartCopy.outerBoundary);
-                QList<QPolygonF> translatedHoles;
-                for(const QPolygonF& hole : placedPartCopy.holes) {
-                    translatedHoles.append(translateToPlace.map(hole));
-                }
-                placedPartCopy.holes = translatedHoles;
-                placedPartCopy.bounds = placedPartCopy.outerBoundary.boundingRect(); // Update bounds to placed location
-
-                partsOnSheetMap[sheetIdx].append(placedPartCopy);
+                // Add this part to the list of obstacles for the current sheet for subsequent placements.
+                // The geometry stays untouched; its NFPs are translated to the placed position on use.
+                sheetState.obstacles.append({partToPlaceOriginal, gene.rotation, bestPos.position});
                 
                 placedThisPart = true;
                 break; 
@@ -225,8 +316,13 @@ double NestingEngine::calculateFitness(Individual& individual, SvgNest::NestSolu
         }
     }
 
-    outSolution.placements = placedPartsList;
-    individual.fitness = evaluateSolutionFitness(placedPartsList, individual.chromosome.size()); // Set fitness on the individual
+    if (checkpointInterval > 0 && chromosome.size() > firstGene) {
+        // Elites and duplicates come back whole in the next generation.
+        placementTrie_.insert(chromosome, chromosome.size(), PlacementStateHandle(new PlacementState(state)));
+    }
+
+    outSolution.placements = state.placements;
+    individual.fitness = evaluateSolutionFitness(state.placements, chromosome.size()); // Set fitness on the individual
     return individual.fitness;
 }
 
@@ -249,6 +345,17 @@ InternalPart NestingEngine::transformPart(const InternalPart& part, double rotat
     } else {
         transformedPart.bounds = QRectF();
     }
+    // The NFP backends read the fixed-point paths, which are rotated directly in integer space.
+    transformedPart.outerPath64 = GeometryUtils::rotatePath64(part.outerPath64, rotation);
+    transformedPart.holesPath64.clear();
+    for (const Clipper2Lib::Path64& hole : part.holesPath64) {
+        transformedPart.holesPath64.push_back(GeometryUtils::rotatePath64(hole, rotation));
+    }
+    // Rotated pieces stay convex up to rounding, which the convex kernel tolerates.
+    transformedPart.convexPieces.clear();
+    for (const Clipper2Lib::Path64& piece : part.convexPieces) {
+        transformedPart.convexPieces.push_back(GeometryUtils::rotatePath64(piece, rotation));
+    }
     return transformedPart;
 }
 
@@ -265,55 +372,82 @@ double NestingEngine::evaluateSolutionFitness(const QList<SvgNest::PlacedPart>&
 }
 
 
+// Key of a part shape at a rotation in SheetPlacementState::obstacleUnions.
+static quint64 obstacleUnionKey(const InternalPart& part, double rotation) {
+    return (static_cast<quint64>(static_cast<quint32>(part.cacheIndex)) << 16) |
+           Geometry::NfpKey::quantizeRotation(rotation);
+}
+
 CandidatePosition NestingEngine::findBestPositionForPart(
-    const InternalPart& partToPlaceTransformed, 
+    const InternalPart& partToPlace, 
     double partRotationVal, 
     const InternalSheet& targetSheet,
-    const QList<InternalPart>& staticObstacles, 
-    const QString& placementStrategy) {
-
-    if (!partToPlaceTransformed.isValid() || !targetSheet.isValid()) {
-        return {QPointF(-1,-1), -1, 0.0};
-    }
-
-    // For NFP generation, partToPlaceTransformed is already rotated.
-    // Sheet and obstacles are assumed to be in their fixed, 0-rotation state on the sheet.
-    QList<QPolygonF> nfpSheet = getNfpInside(partToPlaceTransformed, 0 /*rot for partA is effectively baked in*/, false, 
-                                             targetSheet, 0, false);
-    if (nfpSheet.isEmpty()) {
-        return {QPointF(-1,-1), -1, 0.0};
-    }
-
-    QList<QList<QPolygonF>> nfpObstaclesList;
-    for (const InternalPart& obstacle : staticObstacles) {
-        if (stopRequested_) return {QPointF(-1,-1), -1, 0.0};
-        // Obstacle is already placed, so its geometry is static. PartToPlaceTransformed orbits it.
-        // Obstacle rotation is 0 because its geometry is already in sheet coordinates.
-        QList<QPolygonF> nfpObs = getNfp(partToPlaceTransformed, 0 /*baked in*/, false, 
-                                         obstacle, 0, false, 
-                                         false /*partB (obstacle) is static*/);
-        if (!nfpObs.isEmpty()) {
-            nfpObstaclesList.append(nfpObs);
+    SheetPlacementState& sheetState,
+    const QString& placementStrategy,
+    FeasibleRegion& feasibleRegion) {
+
+    if (!partToPlace.isValid() || !targetSheet.isValid()) {
+        return {Clipper2Lib::Point64(), -1, 0.0};
+    }
+
+    // The part is passed in its original geometry; the rotation is part of the NFP key and only
+    // applied to the geometry when an NFP has to be computed. The sheet is never rotated.
+    Geometry::NfpHandle nfpSheet = getNfpInside(partToPlace, partRotationVal, false,
+                                                targetSheet, 0, false);
+    if (nfpSheet.isNull() || nfpSheet->paths.empty()) {
+        return {Clipper2Lib::Point64(), -1, 0.0};
+    }
+
+    // The union of the obstacle NFPs for this part and rotation only has to take in the parts
+    // placed on the sheet since it was last brought up to date, usually just the previous one,
+    // and each of those is only merged into the tiles of the union around it.
+    ObstacleUnion& obstacleUnion = sheetState.obstacleUnions[obstacleUnionKey(partToPlace, partRotationVal)];
+    if (obstacleUnion.obstacleCount < sheetState.obstacles.size()) {
+        if (obstacleUnion.obstacleCount == 0) {
+            obstacleUnion.setArea(Clipper2Lib::GetBounds(targetSheet.outerPath64));
+        }
+        const QList<PlacedObstacle> newObstacles = sheetState.obstacles.mid(obstacleUnion.obstacleCount);
+        if (nfpBackend_ == Geometry::NfpBackend::CustomMinkowski) {
+            prefetchObstacleNfps(partToPlace, partRotationVal, newObstacles);
+        }
+
+        for (const PlacedObstacle& obstacle : newObstacles) {
+            if (stopRequested_) return {Clipper2Lib::Point64(), -1, 0.0};
+            // The obstacle NFP is computed (and cached) with the obstacle at the origin and unrotated,
+            // then seen through a view rotated and translated to where the obstacle was placed.
+            Geometry::NfpView nfpObs = getNfp(partToPlace, partRotationVal, false,
+                                              *obstacle.part, obstacle.rotation, false,
+                                              false /*partB (obstacle) is static*/);
+            if (!nfpObs.isNull() && !nfpObs.nfp->paths.empty()) {
+                nfpObs.offset = obstacle.position;
+                Clipper2Lib::Paths64 nfp;
+                nfp.reserve(nfpObs.nfp->paths.size());
+                for (size_t i = 0; i < nfpObs.nfp->paths.size(); ++i) {
+                    nfp.push_back(nfpObs.path(i));
+                }
+                obstacleUnion.add(nfp);
+            }
         }
+        obstacleUnion.obstacleCount = static_cast<int>(sheetState.obstacles.size());
     }
     
-    QList<CandidatePosition> candidates = findCandidatePositions(partToPlaceTransformed, nfpSheet, nfpObstaclesList);
+    QList<CandidatePosition> candidates = findCandidatePositions(partToPlace, nfpSheet, obstacleUnion.paths(), feasibleRegion);
     if (candidates.isEmpty()) {
-         return {QPointF(-1,-1), -1, 0.0};
+         return {Clipper2Lib::Point64(), -1, 0.0};
     }
 
-    CandidatePosition bestPosition = {QPointF(-1,-1), -1, 0.0};
+    CandidatePosition bestPosition = {Clipper2Lib::Point64(), -1, 0.0};
     if (placementStrategy == "gravity" || placementStrategy == "bottomleft") { 
-        double minY = std::numeric_limits<double>::max();
-        double minX_at_minY = std::numeric_limits<double>::max();
+        int64_t minY = std::numeric_limits<int64_t>::max();
+        int64_t minX_at_minY = std::numeric_limits<int64_t>::max();
         for (const auto& cand : candidates) {
-            if (cand.position.y() < minY) {
-                minY = cand.position.y();
-                minX_at_minY = cand.position.x();
+            if (cand.position.y < minY) {
+                minY = cand.position.y;
+                minX_at_minY = cand.position.x;
                 bestPosition = cand;
-            } else if (cand.position.y() == minY) {
-                if (cand.position.x() < minX_at_minY) {
-                    minX_at_minY = cand.position.x();
+            } else if (cand.position.y == minY) {
+                if (cand.position.x < minX_at_minY) {
+                    minX_at_minY = cand.position.x;
                     bestPosition = cand;
                 }
             }
@@ -327,96 +461,270 @@ CandidatePosition NestingEngine::findBestPositionForPart(
 }
 
 QList<CandidatePosition> NestingEngine::findCandidatePositions(
-    const InternalPart& partToPlaceTransformed,
-    const QList<QPolygonF>& nfpForPartAndSheet, 
-    const QList<QList<QPolygonF>>& nfPsForPartAndPlacedObstacles) 
+    const InternalPart& partToPlace,
+    const Geometry::NfpHandle& nfpForPartAndSheet,
+    const Clipper2Lib::Paths64& obstacleUnion,
+    FeasibleRegion& feasibleRegion)
 {
     QList<CandidatePosition> validPositions;
-    if (nfpForPartAndSheet.isEmpty() || nfpForPartAndSheet.first().isEmpty()) {
+    if (nfpForPartAndSheet.isNull() || nfpForPartAndSheet->paths.empty()) {
         return validPositions;
     }
 
-    const QPolygonF& mainPlacementRegion = nfpForPartAndSheet.first();
-    for (const QPointF& potentialPos : mainPlacementRegion) {
-        bool overlapsObstacle = false;
-        for (const QList<QPolygonF>& nfpObstacleSet : nfPsForPartAndPlacedObstacles) {
-            for (const QPolygonF& nfpObsPoly : nfpObstacleSet) {
-                if (GeometryUtils::isPointInPolygon(potentialPos, nfpObsPoly, Qt::OddEvenFill)) { 
-                    overlapsObstacle = true;
-                    break;
-                }
+    // Every vertex of the feasible region is a candidate: the corners of the inner NFP that no
+    // obstacle covers, and the points where the part touches the sheet and placed parts together.
+    feasibleRegion.setContainer(nfpForPartAndSheet);
+    feasibleRegion.compute(obstacleUnion);
+    for (const Clipper2Lib::Paths64* paths : {&feasibleRegion.region(), &feasibleRegion.segments()}) {
+        for (const Clipper2Lib::Path64& path : *paths) {
+            for (const Clipper2Lib::Point64& vertex : path) {
+                validPositions.append({vertex, 0, 0.0});
             }
-            if (overlapsObstacle) break;
-        }
-
-        if (!overlapsObstacle) {
-            validPositions.append({potentialPos, 0, 0.0}); 
         }
     }
     return validPositions;
 }
 
 
-QList<QPolygonF> NestingEngine::getNfp(const InternalPart& partA, double rotationA, bool flippedA,
-                                       const InternalPart& partB, double rotationB, bool flippedB,
-                                       bool partAIsStaticInKey) { 
-    
-    // The parts pA_for_nfp, pB_for_nfp are transformed based on rotationA, rotationB for geometry calculation.
-    // The key uses original part IDs and gene-defined rotations/flips.
-    InternalPart pA_for_nfp = transformPart(partA, rotationA); 
-    InternalPart pB_for_nfp = transformPart(partB, rotationB);
-
-    QString cacheKey;
-    if (partAIsStaticInKey) { // partA is static, partB orbits partA
-         cacheKey = nfpCache_.generateKey(partB.id, rotationB, flippedB,   
-                                          partA.id, rotationA, flippedA,   
-                                          true); // True because partA (the second one in key) is static
-    } else { // partA orbits partB, partB is static
-         cacheKey = nfpCache_.generateKey(partA.id, rotationA, flippedA,   
-                                          partB.id, rotationB, flippedB,   
-                                          false); // False because partA (the first one in key) is not static
-    }
-
-    Geometry::CachedNfp cachedNfp;
-    if (nfpCache_.findNfp(cacheKey, cachedNfp)) {
-        return cachedNfp.nfpPolygons;
-    }
-
-    QList<QPolygonF> nfp;
-    if (partAIsStaticInKey) { 
-         nfp = nfpGenerator_.calculateNfp(pB_for_nfp, pA_for_nfp, config_.placementType == "deepnest", false);
-    } else { 
-         nfp = nfpGenerator_.calculateNfp(pA_for_nfp, pB_for_nfp, config_.placementType == "deepnest", false);
+QJsonObject NestingEngine::nfpStatistics() const {
+    return nfpCache_.statisticsJson();
+}
+
+void NestingEngine::reportProgress(int percentage) {
+    if (progressCallback_) {
+        progressCallback_(percentage);
     }
-    
-    nfpCache_.storeNfp(cacheKey, Geometry::CachedNfp(nfp));
-    return nfp;
 }
 
-QList<QPolygonF> NestingEngine::getNfpInside(const InternalPart& partA, double rotationA, bool flippedA,
-                                             const InternalPart& containerB, double rotationB, bool flippedB) {
-    
-    InternalPart pA_for_nfp = transformPart(partA, rotationA);
-    InternalPart pB_container_for_nfp = transformPart(containerB, rotationB);
-
-    // Key for "A fitting inside B (container)": A is dynamic, B is the static frame.
-    // generateKey(dynamicId, dynamicRot, dynamicFlip, staticId, staticRot, staticFlip, is_first_part_static_flag)
-    // Here, partA is dynamic (first part in key), containerB is static (second part in key).
-    // So, the "is_first_part_static_flag" should be false.
-    QString cacheKey = nfpCache_.generateKey(partA.id, rotationA, flippedA,          
-                                             containerB.id, rotationB, flippedB,    
-                                             false); 
-    
-    Geometry::CachedNfp cachedNfp;
-    if (nfpCache_.findNfp(cacheKey, cachedNfp)) {
-        return cachedNfp.nfpPolygons;
+void NestingEngine::precomputeNfps(int progressShare) {
+    QElapsedTimer timer;
+    timer.start();
+
+    // Every NFP the GA can ask for, enumerated from the distinct shapes instead of the genes: each
+    // part shape inside each sheet shape at every rotation, and around each part shape. Outer NFPs
+    // are keyed by the relative rotation (resolveNfpRequest), so the obstacle stays at 0 and the
+    // part takes every rotation step. Shapes are distinct by cacheIndex, so the keys are too.
+    QVector<double> rotations;
+    const int rotationSteps = qMax(1, config_.rotations);
+    for (int step = 0; step < rotationSteps; ++step) {
+        rotations.append(step * (360.0 / rotationSteps));
+    }
+    QHash<int, const InternalPart*> shapes;
+    QHash<int, int> instances; // Part instances per shape: a single instance is never its own obstacle
+    for (const InternalPart& part : allParts_) {
+        if (!part.isValid()) continue;
+        if (!shapes.contains(part.cacheIndex)) shapes.insert(part.cacheIndex, &part);
+        ++instances[part.cacheIndex];
+    }
+    QHash<int, const InternalSheet*> sheetShapes;
+    for (const InternalSheet& sheet : sheets_) {
+        if (sheet.isValid() && !sheetShapes.contains(sheet.cacheIndex)) sheetShapes.insert(sheet.cacheIndex, &sheet);
+    }
+
+    QVector<NfpPrecomputeTask> tasks;
+    for (const InternalPart* part : shapes) {
+        for (double rotation : rotations) {
+            for (const InternalSheet* sheet : sheetShapes) {
+                if (nfpCache_.contains(Geometry::NfpCache::generateKey(part->cacheIndex, rotation, false,
+                                                                       sheet->cacheIndex, 0, false, true))) continue;
+                tasks.append({part, nullptr, sheet, rotation, 0,
+                              static_cast<qint64>(part->outerBoundary.size()) * sheet->outerBoundary.size()});
+            }
+            for (const InternalPart* obstacle : shapes) {
+                if (obstacle == part && instances.value(part->cacheIndex) < 2) continue;
+                if (nfpCache_.contains(resolveNfpRequest(*part, rotation, false, *obstacle, 0, false, false).key)) continue;
+                tasks.append({part, obstacle, nullptr, rotation, 0,
+                              static_cast<qint64>(part->outerBoundary.size()) * obstacle->outerBoundary.size()});
+            }
+        }
+    }
+    if (tasks.isEmpty()) {
+        reportProgress(progressShare);
+        return;
+    }
+
+    // Largest pairs first, so the expensive tail does not end up on a single thread.
+    std::sort(tasks.begin(), tasks.end(), [](const NfpPrecomputeTask& a, const NfpPrecomputeTask& b) {
+        return a.cost > b.cost;
+    });
+
+    // Every pool thread runs the same loop and claims the next batch of tasks from a shared
+    // atomic cursor, so idle threads keep taking work until the queue is drained.
+    QAtomicInt nextTask(0);
+    QAtomicInt completedTasks(0);
+    QAtomicInt reportedProgress(-1);
+    const int totalTasks = tasks.size();
+    // With a memory budget, stop once the cache is full: further entries would only evict
+    // precomputed ones before the evaluations get to use them. memoryUsage() locks every
+    // shard, so it is checked once per batch.
+    const qint64 budget = config_.nfpCacheMemoryBudget;
+    QAtomicInt budgetReached(0);
+    auto runTasks = [&]() {
+        for (;;) {
+            if (stopRequested_) return;
+            if (budget > 0 && nfpCache_.memoryUsage() >= budget) {
+                budgetReached.storeRelaxed(1);
+                return;
+            }
+            const int first = nextTask.fetchAndAddRelaxed(PRECOMPUTE_BATCH_SIZE);
+            if (first >= totalTasks) return;
+
+            const int last = qMin(first + PRECOMPUTE_BATCH_SIZE, totalTasks);
+            for (int index = first; index < last && !stopRequested_; ++index) {
+                const NfpPrecomputeTask& task = tasks[index];
+                if (task.obstacle) {
+                    getNfp(*task.part, task.rotation, false, *task.obstacle, task.obstacleRotation, false, false);
+                } else {
+                    getNfpInside(*task.part, task.rotation, false, *task.sheet, 0, false);
+                }
+
+                const int completed = completedTasks.fetchAndAddRelaxed(1) + 1;
+                const int percentage = progressShare * completed / totalTasks;
+                const int reported = reportedProgress.loadRelaxed();
+                if (percentage > reported && reportedProgress.testAndSetRelaxed(reported, percentage)) {
+                    reportProgress(percentage);
+                }
+            }
+        }
+    };
+
+    const int batchCount = (totalTasks + PRECOMPUTE_BATCH_SIZE - 1) / PRECOMPUTE_BATCH_SIZE;
+    const int threadCount = qMax(1, qMin(QThreadPool::globalInstance()->maxThreadCount(), batchCount));
+    QList<QFuture<void>> workers;
+    for (int i = 0; i < threadCount; ++i) {
+        workers.append(QtConcurrent::run(runTasks));
+    }
+    for (QFuture<void>& worker : workers) {
+        worker.waitForFinished();
+    }
+
+    if (budgetReached.loadRelaxed()) {
+        qDebug() << "NestingEngine: NFP cache budget reached, precomputation stopped early.";
+    }
+    qDebug() << "NestingEngine: Precomputed" << completedTasks.loadRelaxed() << "of" << totalTasks << "NFPs for"
+             << shapes.size() << "part shapes on" << threadCount << "threads in" << timer.elapsed() << "ms";
+}
+
+NestingEngine::NfpRequest NestingEngine::resolveNfpRequest(const InternalPart& partA, double rotationA, bool flippedA,
+                                                          const InternalPart& partB, double rotationB, bool flippedB,
+                                                          bool partAIsStaticInKey) const {
+    NfpRequest request;
+    request.orbiting = partAIsStaticInKey ? &partB : &partA;
+    request.stationary = partAIsStaticInKey ? &partA : &partB;
+    request.orbitingRotation = partAIsStaticInKey ? rotationB : rotationA;
+    request.stationaryRotation = partAIsStaticInKey ? rotationA : rotationB;
+    const bool orbitingFlipped = partAIsStaticInKey ? flippedB : flippedA;
+    const bool stationaryFlipped = partAIsStaticInKey ? flippedA : flippedB;
+
+    // Rotating both parts about their origins rotates their NFP the same way:
+    // NFP(A@ra, B@rb) = rotate(NFP(A@(ra-rb), B@0), rb). Only the relative rotation goes into
+    // the key and the stationary rotation is applied by the returned view, so one entry serves
+    // every rotation pair with the same difference. Flips do not commute with rotation, so
+    // flipped pairs keep absolute keys.
+    request.viewRotation = 0.0;
+    if (!orbitingFlipped && !stationaryFlipped && request.stationaryRotation != 0.0) {
+        request.viewRotation = request.stationaryRotation;
+        request.orbitingRotation -= request.stationaryRotation;
+        request.stationaryRotation = 0.0;
+    }
+
+    // The key uses interned part indices and the canonical rotations/flips.
+    request.key = Geometry::NfpCache::generateKey(request.orbiting->cacheIndex, request.orbitingRotation, orbitingFlipped,
+                                                  request.stationary->cacheIndex, request.stationaryRotation, stationaryFlipped,
+                                                  false);
+    return request;
+}
+
+Geometry::NfpView NestingEngine::getNfp(const InternalPart& partA, double rotationA, bool flippedA,
+                                        const InternalPart& partB, double rotationB, bool flippedB,
+                                        bool partAIsStaticInKey) {
+    const NfpRequest request = resolveNfpRequest(partA, rotationA, flippedA, partB, rotationB, flippedB, partAIsStaticInKey);
+
+    Geometry::NfpHandle cachedNfp = findOrComputeNfp(request.key, request.orbiting->fingerprint,
+                                                     request.stationary->fingerprint, [&]() {
+        // Only transform the geometry on a miss; hits never touch the parts.
+        InternalPart orbitingForNfp = transformPart(*request.orbiting, request.orbitingRotation);
+        InternalPart stationaryForNfp = transformPart(*request.stationary, request.stationaryRotation);
+        return nfpGenerator_.calculateNfp(orbitingForNfp, stationaryForNfp, nfpBackend_, false);
+    });
+    return Geometry::NfpView(cachedNfp, Clipper2Lib::Point64(), request.viewRotation);
+}
+
+void NestingEngine::prefetchObstacleNfps(const InternalPart& partToPlace, double partRotation,
+                                         const QList<PlacedObstacle>& obstacles) {
+    QVector<NfpRequest> missing;
+    QSet<Geometry::NfpKey> seen;
+    for (const PlacedObstacle& obstacle : obstacles) {
+        const NfpRequest request = resolveNfpRequest(partToPlace, partRotation, false,
+                                                     *obstacle.part, obstacle.rotation, false, false);
+        if (seen.contains(request.key) || nfpCache_.contains(request.key)) continue;
+        seen.insert(request.key);
+        missing.append(request);
+    }
+    if (missing.size() < 2) {
+        return; // Nothing to run in parallel, getNfp computes a single miss itself
     }
+
+    QVector<InternalPart> geometry;
+    geometry.reserve(2 * missing.size());
+    for (const NfpRequest& request : missing) {
+        geometry.append(transformPart(*request.orbiting, request.orbitingRotation));
+        geometry.append(transformPart(*request.stationary, request.stationaryRotation));
+    }
+    QVector<Geometry::NfpPair> pairs;
+    pairs.reserve(missing.size());
+    for (int i = 0; i < missing.size(); ++i) {
+        pairs.append({&geometry[2 * i], &geometry[2 * i + 1]});
+    }
+    const QVector<Clipper2Lib::Paths64> nfps = nfpGenerator_.calculateNfpBatch(pairs, nfpBackend_);
+
+    // Publish through the regular path so the results reach the disk store and single-flight
+    // waiters like any other miss. An entry another thread stored meanwhile wins. Failed pairs
+    // come back empty and are left out: getNfp computes them on its own.
+    for (int i = 0; i < missing.size(); ++i) {
+        if (nfps[i].empty()) continue;
+        findOrComputeNfp(missing[i].key, missing[i].orbiting->fingerprint, missing[i].stationary->fingerprint,
+                         [&]() { return nfps[i]; });
+    }
+}
+
+Geometry::NfpHandle NestingEngine::getNfpInside(const InternalPart& partA, double rotationA, bool flippedA,
+                                                const InternalPart& containerB, double rotationB, bool flippedB) {
     
-    QList<QPolygonF> nfp = nfpGenerator_.calculateNfpInside(pA_for_nfp, pB_container_for_nfp, config_.placementType == "deepnest", false);
+    // Key for "A fitting inside B (container)": A is the first part in the key, B the static frame.
+    Geometry::NfpKey cacheKey = Geometry::NfpCache::generateKey(partA.cacheIndex, rotationA, flippedA,
+                                                                containerB.cacheIndex, rotationB, flippedB,
+                                                                true);
     
-    nfpCache_.storeNfp(cacheKey, Geometry::CachedNfp(nfp));
-    return nfp;
+    return findOrComputeNfp(cacheKey, partA.fingerprint, containerB.fingerprint, [&]() {
+        InternalPart pA_for_nfp = transformPart(partA, rotationA);
+        InternalPart pB_container_for_nfp = transformPart(containerB, rotationB);
+        return nfpGenerator_.calculateNfpInside(pA_for_nfp, pB_container_for_nfp, nfpBackend_, false);
+    });
 }
 
+Geometry::NfpHandle NestingEngine::findOrComputeNfp(const Geometry::NfpKey& cacheKey, quint64 shapeA, quint64 shapeB,
+                                                    const std::function<Clipper2Lib::Paths64()>& calculate) {
+    const bool persistent = nfpDiskStore_.isEnabled() && shapeA != 0 && shapeB != 0;
+    bool calculated = false;
+    // Concurrent misses on the same key are single-flighted by the cache: one thread runs
+    // this lambda, the others wait for its result.
+    Geometry::NfpHandle handle = nfpCache_.getOrCompute(cacheKey, [&]() {
+        if (persistent) {
+            Geometry::NfpDiskEntry stored;
+            if (nfpDiskStore_.find(Geometry::NfpDiskKey::fromKey(cacheKey, shapeA, shapeB), stored)) {
+                // Copied out of the mapping: cache entries are Paths64 for Clipper2 and outlive
+                // the segments, which flush() may unmap.
+                return Geometry::CachedNfp(stored.toPaths());
+            }
+        }
+        calculated = true;
+        return Geometry::CachedNfp(calculate());
+    });
+    if (calculated && persistent) {
+        nfpDiskStore_.record(Geometry::NfpDiskKey::fromKey(cacheKey, shapeA, shapeB), handle);
+    }
+    return handle;
+}
 
 } // namespace Core
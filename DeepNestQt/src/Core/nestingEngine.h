@@ -5,6 +5,9 @@
 #include "geneticAlgorithm.h"    // For Core::GeneticAlgorithm, Core::Individual
 #include "nfpGenerator.h"        // For Geometry::NfpGenerator
 #include "nfpCache.h"            // For Geometry::NfpCache
+#include "nfpDiskStore.h"        // For Geometry::NfpDiskStore
+#include "feasibleRegion.h"      // For Core::FeasibleRegion
+#include "placementTrie.h"       // For Core::PlacementTrie, Core::SheetPlacementState
 #include "svgNest.h"             // For SvgNest::Configuration, SvgNest::NestSolution, SvgNest::PlacedPart
 #include <QList>
 #include <QVector>
@@ -12,14 +15,17 @@
 #include <QtConcurrent/QtConcurrent> // For QtConcurrent::mapped
 #include <QFuture>                 // For QFuture
 #include <QMutex>                  // For protecting shared resources if any (e.g. solutions list)
+#include <QJsonObject>             // For nfpStatistics()
+#include <functional>              // For std::function (progress callback)
 
 
 namespace Core {
 
 // Structure to hold information about a possible placement position for a part
+// Positions are in the fixed-point coordinates of the NFPs (Configuration::clipperScale).
 struct CandidatePosition {
-    QPointF position;
-    double sheetIndex; // Which sheet this position is on
+    Clipper2Lib::Point64 position;
+    double sheetIndex; // Which sheet this position is on, -1 when no position was found
     double partRotation; // Rotation of the part at this position (already applied to NFP context)
     // Add other metrics if needed, e.g., score for this position by placement strategy
 };
@@ -40,6 +46,13 @@ public:
     // Allows NestingWorker to request a stop
     void requestStop() { stopRequested_ = true; }
 
+    // Receives the overall progress (0-99) of runNesting. May be called from pool threads.
+    typedef std::function<void(int)> ProgressCallback;
+    void setProgressCallback(const ProgressCallback& callback) { progressCallback_ = callback; }
+
+    // NFP cache counters, entry/byte totals and computation latency histograms (see NfpCache::statisticsJson).
+    QJsonObject nfpStatistics() const;
+
 
     // Fitness callback for the Genetic Algorithm
     // This method is called by the GA (or by NestingEngine itself after GA creates individuals)
@@ -48,18 +61,30 @@ public:
     // and returns a fitness score. The SvgNest::NestSolution is also populated.
     double calculateFitness(Individual& individual, SvgNest::NestSolution& outSolution);
 
+    // Computes the NFPs the GA can ask for (each part shape at each rotation inside each sheet,
+    // and around each part shape) on all cores, so fitness evaluations start from a warm cache.
+    // Stops early once the NFP cache reaches Configuration::nfpCacheMemoryBudget.
+    // Reports progress from 0 to 'progressShare' percent.
+    void precomputeNfps(int progressShare);
+
 
 private:
     SvgNest::Configuration config_;
     QList<InternalPart>& allParts_; // Reference to list of all part instances to be placed
     QList<InternalSheet> sheets_;   // Available sheets
+    const Geometry::NfpBackend nfpBackend_; // Resolved from Configuration::nfpBackend / placementType
 
     Geometry::NfpCache nfpCache_;
+    Geometry::NfpDiskStore nfpDiskStore_; // Persistent second level behind nfpCache_, disabled without a directory
     Geometry::NfpGenerator nfpGenerator_;
     GeneticAlgorithm geneticAlgorithm_;
+    PlacementTrie placementTrie_; // Placement states of chromosome prefixes, shared by all evaluations
 
     bool stopRequested_;
     int solutionsFoundCount_; // Counter for unique solutions
+    ProgressCallback progressCallback_;
+
+    void reportProgress(int percentage);
 
     // --- Core Placement Logic ---
     // Attempts to place all parts defined in an individual's chromosome.
@@ -67,35 +92,65 @@ private:
     QList<SvgNest::PlacedPart> placePartsForIndividual(const QVector<Gene>& chromosome, const QList<InternalSheet>& targetSheets);
 
     // Finds the best position for a single part on a given sheet, considering already placed parts.
-    // `currentPlacedParts` are those already on `targetSheet`.
+    // `sheetState` holds the parts already on `targetSheet`; the obstacle union for this part and
+    // rotation is brought up to date with them.
     CandidatePosition findBestPositionForPart(
-        const InternalPart& partToPlace,
-        double partRotation, // Rotation already applied to partToPlace's geometry for NFP context
+        const InternalPart& partToPlace, // Original geometry, the rotation is applied through the NFPs
+        double partRotation,
         const InternalSheet& targetSheet,
-        const QList<InternalPart>& staticParts, // Parts already placed on the sheet (these form obstacles)
-        const QString& placementStrategy
+        SheetPlacementState& sheetState,
+        const QString& placementStrategy,
+        FeasibleRegion& feasibleRegion // Stage of the calling evaluation
     );
     
-    // Helper to get the NFP for two parts (A orbiting B)
-    QList<QPolygonF> getNfp(const InternalPart& partA, double rotationA, bool flippedA,
-                            const InternalPart& partB, double rotationB, bool flippedB,
-                            bool partAIsStatic); // partA is static, partB orbits
+    // Helper to get the NFP for two parts (A orbiting B).
+    // The cache holds the NFP for the relative rotation only; the returned view applies the
+    // static part's rotation on top of the shared entry, the polygons are never copied.
+    Geometry::NfpView getNfp(const InternalPart& partA, double rotationA, bool flippedA,
+                             const InternalPart& partB, double rotationB, bool flippedB,
+                             bool partAIsStatic); // partA is static, partB orbits
+
+    // Canonical form of an outer NFP request: the cache key, the geometry to compute it from and
+    // the rotation the returned view applies (see getNfp).
+    struct NfpRequest {
+        Geometry::NfpKey key;
+        const InternalPart* orbiting;
+        const InternalPart* stationary;
+        double orbitingRotation;
+        double stationaryRotation;
+        double viewRotation;
+    };
+    NfpRequest resolveNfpRequest(const InternalPart& partA, double rotationA, bool flippedA,
+                                 const InternalPart& partB, double rotationB, bool flippedB,
+                                 bool partAIsStatic) const;
+
+    // For the "deepnest" placement: computes all obstacle NFPs of one placement step that are not
+    // cached yet in a single NfpGenerator::calculateNfpBatch call, so the per-obstacle lookups hit.
+    void prefetchObstacleNfps(const InternalPart& partToPlace, double partRotation,
+                              const QList<PlacedObstacle>& obstacles);
 
     // Helper to get NFP for partA to fit inside partB (container)
-    QList<QPolygonF> getNfpInside(const InternalPart& partA, double rotationA, bool flippedA,
-                                  const InternalPart& containerB, double rotationB, bool flippedB);
+    Geometry::NfpHandle getNfpInside(const InternalPart& partA, double rotationA, bool flippedA,
+                                     const InternalPart& containerB, double rotationB, bool flippedB);
+
+    // Returns the NFP for 'cacheKey' from nfpCache_, else from the persistent store (when enabled and
+    // both shapes have a fingerprint), else runs 'calculate' and queues the result for the store.
+    Geometry::NfpHandle findOrComputeNfp(const Geometry::NfpKey& cacheKey, quint64 shapeA, quint64 shapeB,
+                                         const std::function<Clipper2Lib::Paths64()>& calculate);
 
-    // Helper to transform an InternalPart (e.g., by rotation)
+    // Helper to transform an InternalPart (e.g., by rotation), including its fixed-point paths
     InternalPart transformPart(const InternalPart& part, double rotation);
     
     // Function to convert list of placed parts to a fitness score
     double evaluateSolutionFitness(const QList<SvgNest::PlacedPart>& placements, int totalParts);
 
-    // Placeholder for actual geometric operations for placement strategies
+    // Candidate positions: the vertices of the feasible region, the inner NFP minus the union of
+    // the obstacle NFPs, computed by 'feasibleRegion' in one Clipper2 execution.
     QList<CandidatePosition> findCandidatePositions(
-        const InternalPart& partToPlaceTransformed, // Part to place, already rotated
-        const QList<QPolygonF>& nfpForPartAndSheet, // NFP of (SheetBoundary - PartToPlace)
-        const QList<QList<QPolygonF>>& nfPsForPartAndPlacedObstacles // List of NFPs (PlacedObstacle_i - PartToPlace)
+        const InternalPart& partToPlace,
+        const Geometry::NfpHandle& nfpForPartAndSheet, // NFP of (SheetBoundary - PartToPlace)
+        const Clipper2Lib::Paths64& obstacleUnion, // Union of the NFPs (PlacedObstacle_i - PartToPlace)
+        FeasibleRegion& feasibleRegion
     );
 };
 
@@ -0,0 +1,91 @@
+#include "obstacleUnion.h"
+#include <algorithm> // For std::max
+
+namespace Core {
+
+static quint64 cellKey(int64_t column, int64_t row) {
+    return (static_cast<quint64>(static_cast<quint32>(column)) << 32) | static_cast<quint32>(row);
+}
+
+static qint64 pathsBytes(const Clipper2Lib::Paths64& paths) {
+    qint64 bytes = static_cast<qint64>(paths.capacity() * sizeof(Clipper2Lib::Path64));
+    for (const Clipper2Lib::Path64& path : paths) {
+        bytes += static_cast<qint64>(path.capacity() * sizeof(Clipper2Lib::Point64));
+    }
+    return bytes;
+}
+
+int64_t ObstacleUnion::cellIndex(int64_t coordinate) const {
+    // Floor division, so cells do not straddle the origin.
+    const int64_t index = coordinate / cellSize_;
+    return (coordinate % cellSize_ != 0 && coordinate < 0) ? index - 1 : index;
+}
+
+void ObstacleUnion::setArea(const Clipper2Lib::Rect64& sheetBounds) {
+    if (!tiles_.isEmpty()) return;
+    cellSize_ = std::max<int64_t>(std::max(sheetBounds.Width(), sheetBounds.Height()) / kCellsPerSide, 1);
+}
+
+void ObstacleUnion::add(const Clipper2Lib::Paths64& nfp) {
+    if (nfp.empty()) return;
+    pathsValid_ = false;
+    const Clipper2Lib::Rect64 nfpBounds = Clipper2Lib::GetBounds(nfp);
+    if (cellSize_ == 0) {
+        cellSize_ = std::max<int64_t>(std::max(nfpBounds.Width(), nfpBounds.Height()), 1);
+    }
+
+    const int64_t column0 = cellIndex(nfpBounds.left), row0 = cellIndex(nfpBounds.top);
+    const int64_t column1 = cellIndex(nfpBounds.right), row1 = cellIndex(nfpBounds.bottom);
+    if (!singleTile_ && (column1 - column0 + 1) * (row1 - row0 + 1) > kMaxCellsPerAdd) {
+        // Cutting this NFP into so many tiles would cost more than uniting it with everything.
+        Clipper2Lib::Paths64 all;
+        for (const Clipper2Lib::Paths64& tile : tiles_) all.insert(all.end(), tile.begin(), tile.end());
+        tiles_.clear();
+        tiles_.insert(0, Clipper2Lib::Union(all, Clipper2Lib::FillRule::NonZero));
+        singleTile_ = true;
+    }
+    if (singleTile_) {
+        Clipper2Lib::Paths64& tile = tiles_[0];
+        tile = Clipper2Lib::Union(tile, nfp, Clipper2Lib::FillRule::NonZero);
+        return;
+    }
+
+    for (int64_t column = column0; column <= column1; ++column) {
+        for (int64_t row = row0; row <= row1; ++row) {
+            const Clipper2Lib::Rect64 cell(column * cellSize_, row * cellSize_,
+                                           (column + 1) * cellSize_, (row + 1) * cellSize_);
+            Clipper2Lib::Paths64& tile = tiles_[cellKey(column, row)];
+            // (tile + NFP) clipped to the cell; the tile already lies inside it.
+            Clipper2Lib::Clipper64 clipper;
+            clipper.AddSubject(tile);
+            clipper.AddSubject(nfp);
+            clipper.AddClip({cell.AsPath()});
+            Clipper2Lib::Paths64 merged;
+            clipper.Execute(Clipper2Lib::ClipType::Intersection, Clipper2Lib::FillRule::NonZero, merged);
+            if (merged.empty()) {
+                tiles_.remove(cellKey(column, row));
+            } else {
+                tile = std::move(merged);
+            }
+        }
+    }
+}
+
+const Clipper2Lib::Paths64& ObstacleUnion::paths() {
+    if (!pathsValid_) {
+        paths_.clear();
+        for (const Clipper2Lib::Paths64& tile : tiles_) {
+            paths_.insert(paths_.end(), tile.begin(), tile.end());
+        }
+        pathsValid_ = true;
+    }
+    return paths_;
+}
+
+qint64 ObstacleUnion::memoryUsage() const {
+    qint64 bytes = pathsBytes(paths_);
+    for (const Clipper2Lib::Paths64& tile : tiles_) bytes += pathsBytes(tile);
+    return bytes;
+}
+
+} // namespace Core
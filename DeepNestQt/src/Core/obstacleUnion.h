@@ -0,0 +1,51 @@
+#ifndef OBSTACLEUNION_H
+#define OBSTACLEUNION_H
+
+#include "Clipper2/clipper.h" // For Clipper2Lib::Paths64, Rect64
+#include <QHash>
+#include <cstdint>
+
+namespace Core {
+
+// Running union of the obstacle NFPs of one part shape at one rotation on a sheet, like the JS
+// clipCache: it covers the first 'obstacleCount' obstacles and is extended as parts are placed.
+// The union is kept in tiles of a uniform grid, each holding the part of the union inside its
+// cell. An obstacle NFP (a placed part expanded by the part to place) is only merged into the
+// tiles its bounds overlap, its neighbours, instead of with everything placed before it.
+class ObstacleUnion {
+public:
+    int obstacleCount = 0;
+
+    static const int kCellsPerSide = 8;
+    static const int kMaxCellsPerAdd = 64;
+
+    // Sizes the cells from the sheet, kCellsPerSide across its larger side; only before the first
+    // add(), which otherwise takes the first NFP's extent. An obstacle NFP spans the obstacle and
+    // the part to place, at most two sheets, so even a large obstacle after small ones meets a
+    // bounded number of cells. Should one still reach more than kMaxCellsPerAdd cells, the tiles
+    // are merged into a single one and later NFPs are united with it, a plain running union.
+    void setArea(const Clipper2Lib::Rect64& sheetBounds);
+    // Adds one obstacle NFP, a NonZero region translated to the obstacle.
+    void add(const Clipper2Lib::Paths64& nfp);
+    // All tiles, rings with holes (NonZero). Tiles of one cluster meet along the cell edges, so
+    // a point on a ring is not necessarily on the union's boundary; FeasibleRegion clips and
+    // locates against the filled region (BatchPointInPolygon), which sees through the seams.
+    // Rebuilt after an add().
+    const Clipper2Lib::Paths64& paths();
+    int tileCount() const { return tiles_.size(); }
+    int64_t cellSize() const { return cellSize_; }
+    // Bytes held by the tiles and the assembled paths.
+    qint64 memoryUsage() const;
+
+private:
+    int64_t cellIndex(int64_t coordinate) const;
+
+    int64_t cellSize_ = 0; // Set by setArea() or the first add()
+    bool singleTile_ = false; // One tile holds the whole union (tiles_[0]), see kMaxCellsPerAdd
+    QHash<quint64, Clipper2Lib::Paths64> tiles_; // Keyed by cell column and row, occupied cells only
+    Clipper2Lib::Paths64 paths_;
+    bool pathsValid_ = true;
+};
+
+} // namespace Core
+#endif // OBSTACLEUNION_H
@@ -0,0 +1,119 @@
+#include "placementTrie.h"
+#include "nfpCache.h" // For Geometry::NfpKey::quantizeRotation
+#include <QReadLocker>
+#include <QWriteLocker>
+
+namespace Core {
+
+PlacementTrie::PlacementTrie(qint64 memoryBudget)
+    : root_(new Node), generation_(0), stateCount_(0), memoryUsage_(0), memoryBudget_(memoryBudget) {
+}
+
+PlacementTrie::~PlacementTrie() {
+}
+
+quint64 PlacementTrie::geneKey(const Gene& gene) {
+    // The part instance decides both the geometry and the reported part ID.
+    return (static_cast<quint64>(static_cast<quint32>(gene.sourceIndex)) << 16) |
+           Geometry::NfpKey::quantizeRotation(gene.rotation);
+}
+
+int PlacementTrie::findLongestPrefix(const QVector<Gene>& chromosome, PlacementStateHandle& state) const {
+    QReadLocker locker(&lock_);
+    state.clear();
+    int length = 0;
+    const Node* node = root_.get();
+    for (int i = 0; i < chromosome.size(); ++i) {
+        auto it = node->children.find(geneKey(chromosome[i]));
+        if (it == node->children.end()) break;
+        node = it->second.get();
+        node->lastUsed.storeRelaxed(generation_);
+        if (!node->state.isNull()) {
+            state = node->state;
+            length = i + 1;
+        }
+    }
+    return length;
+}
+
+bool PlacementTrie::insert(const QVector<Gene>& chromosome, int length, const PlacementStateHandle& state) {
+    const qint64 bytes = stateBytes(*state); // Outside the lock, it walks the whole state
+    QWriteLocker locker(&lock_);
+    Node* node = root_.get();
+    for (int i = 0; i < length && i < chromosome.size(); ++i) {
+        std::unique_ptr<Node>& child = node->children[geneKey(chromosome[i])];
+        if (!child) child.reset(new Node);
+        node = child.get();
+        node->lastUsed.storeRelaxed(generation_);
+    }
+    if (node == root_.get()) return false;
+    if (!node->state.isNull()) return true; // Equal to 'state', placement is deterministic
+    if (memoryBudget_ > 0 && memoryUsage_ + bytes > memoryBudget_) return false;
+    node->state = state;
+    node->stateBytes = bytes;
+    ++stateCount_;
+    memoryUsage_ += bytes;
+    return true;
+}
+
+qint64 PlacementTrie::stateBytes(const PlacementState& state) {
+    qint64 bytes = static_cast<qint64>(sizeof(PlacementState));
+    for (const SvgNest::PlacedPart& placement : state.placements) {
+        bytes += static_cast<qint64>(sizeof(SvgNest::PlacedPart)) + placement.partId.size() * static_cast<qint64>(sizeof(QChar));
+    }
+    for (const SheetPlacementState& sheet : state.sheets) {
+        bytes += static_cast<qint64>(sizeof(SheetPlacementState)) +
+                 sheet.obstacles.size() * static_cast<qint64>(sizeof(PlacedObstacle));
+        for (const ObstacleUnion& obstacleUnion : sheet.obstacleUnions) {
+            bytes += static_cast<qint64>(sizeof(ObstacleUnion)) + obstacleUnion.memoryUsage();
+        }
+    }
+    return bytes;
+}
+
+void PlacementTrie::forget(const Node& node) {
+    if (!node.state.isNull()) {
+        --stateCount_;
+        memoryUsage_ -= node.stateBytes;
+    }
+    for (const auto& child : node.children) forget(*child.second);
+}
+
+void PlacementTrie::prune(Node& node, int oldest) {
+    for (auto it = node.children.begin(); it != node.children.end();) {
+        Node& child = *it->second;
+        if (child.lastUsed.loadRelaxed() < oldest) {
+            // Reaching a descendant marks its ancestors, so the whole subtree is unused.
+            forget(child);
+            it = node.children.erase(it);
+        } else {
+            prune(child, oldest);
+            ++it;
+        }
+    }
+}
+
+void PlacementTrie::beginGeneration(int generation) {
+    QWriteLocker locker(&lock_);
+    generation_ = generation;
+    prune(*root_, generation - 1);
+}
+
+void PlacementTrie::clear() {
+    QWriteLocker locker(&lock_);
+    root_.reset(new Node);
+    stateCount_ = 0;
+    memoryUsage_ = 0;
+}
+
+int PlacementTrie::stateCount() const {
+    QReadLocker locker(&lock_);
+    return stateCount_;
+}
+
+qint64 PlacementTrie::memoryUsage() const {
+    QReadLocker locker(&lock_);
+    return memoryUsage_;
+}
+
+} // namespace Core
@@ -0,0 +1,96 @@
+#ifndef PLACEMENTTRIE_H
+#define PLACEMENTTRIE_H
+
+#include "internalTypes.h"    // For Core::InternalPart
+#include "geneticAlgorithm.h" // For Core::Gene
+#include "svgNest.h"          // For SvgNest::PlacedPart
+#include "obstacleUnion.h"    // For Core::ObstacleUnion
+#include <QAtomicInt>
+#include <QHash>
+#include <QList>
+#include <QReadWriteLock>
+#include <QSharedPointer>
+#include <QVector>
+#include <memory>
+#include <unordered_map>
+
+namespace Core {
+
+// A part already placed on a sheet, kept in its original (untransformed) geometry.
+// Obstacle NFPs are looked up for the part at the origin and translated by 'position',
+// so the same cache entry serves every location the obstacle is placed at.
+struct PlacedObstacle {
+    const InternalPart* part; // Into NestingEngine::allParts_, which outlives every placement state
+    double rotation;
+    Clipper2Lib::Point64 position;
+};
+
+// Placement state of one sheet during a fitness evaluation.
+struct SheetPlacementState {
+    QList<PlacedObstacle> obstacles;            // In placement order, only ever appended to
+    QHash<quint64, ObstacleUnion> obstacleUnions; // Keyed by part cacheIndex and quantized rotation
+};
+
+// Everything a fitness evaluation has built after placing a prefix of its chromosome.
+struct PlacementState {
+    QList<SvgNest::PlacedPart> placements;
+    QHash<int, SheetPlacementState> sheets; // By sheet index
+};
+
+typedef QSharedPointer<const PlacementState> PlacementStateHandle;
+
+// Placement states of chromosome prefixes, shared by the fitness evaluations of all individuals.
+// Placement is deterministic, so two chromosomes that start with the same genes (part instance and
+// rotation) reach the same state; after crossover and elitism many share long prefixes, and an
+// evaluation resumes from the longest stored one instead of replaying it. States are stored at
+// checkpoints (Configuration::placementCheckpointInterval). When a generation begins, the prefixes
+// no evaluation of the previous one reached are dropped. The stored states are also bounded in
+// bytes (Configuration::placementCheckpointMemoryBudget): once full, new checkpoints are not
+// stored until pruning frees room. Thread-safe.
+class PlacementTrie {
+public:
+    // memoryBudget is in bytes, 0 means unbounded.
+    explicit PlacementTrie(qint64 memoryBudget = 0);
+    ~PlacementTrie();
+
+    // Length of the longest prefix of 'chromosome' with a stored state (0 if none); sets 'state'.
+    int findLongestPrefix(const QVector<Gene>& chromosome, PlacementStateHandle& state) const;
+    // Stores the state reached after the first 'length' genes of 'chromosome'. Returns false if
+    // it would exceed the memory budget.
+    bool insert(const QVector<Gene>& chromosome, int length, const PlacementStateHandle& state);
+
+    // Called before each generation is evaluated: drops the prefixes the previous one did not reach.
+    void beginGeneration(int generation);
+    void clear();
+
+    int stateCount() const;
+    qint64 memoryUsage() const;
+
+    // Bytes a stored state holds. An upper bound: data the state still shares with the evaluation
+    // that produced it, or with other states (Qt implicit sharing), is counted for each of them.
+    static qint64 stateBytes(const PlacementState& state);
+
+private:
+    struct Node {
+        std::unordered_map<quint64, std::unique_ptr<Node>> children; // By geneKey
+        PlacementStateHandle state; // Null between checkpoints
+        qint64 stateBytes = 0;      // stateBytes(*state), 0 without a state
+        mutable QAtomicInt lastUsed; // Generation of the last evaluation that reached this node
+    };
+
+    static quint64 geneKey(const Gene& gene);
+    // Removes the children of 'node' last used before 'oldest'. The lock must be held for writing.
+    void prune(Node& node, int oldest);
+    // Takes the states in the subtree of 'node' off the counters.
+    void forget(const Node& node);
+
+    mutable QReadWriteLock lock_;
+    std::unique_ptr<Node> root_;
+    int generation_;
+    int stateCount_;
+    qint64 memoryUsage_;
+    const qint64 memoryBudget_;
+};
+
+} // namespace Core
+#endif // PLACEMENTTRIE_H
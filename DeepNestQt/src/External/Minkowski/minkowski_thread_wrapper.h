@@ -8,8 +8,8 @@
 namespace CustomMinkowski {
 
 struct NfpTaskItem {
-    PolygonWithHoles partA; // The orbiting/moving part
-    PolygonWithHoles partB; // The static part
+    PolygonWithHoles partA; // The static part (first argument of CalculateNfp)
+    PolygonWithHoles partB; // The orbiting/moving part
     int taskId;             // To identify the result
     // Add any other per-pair parameters if needed, e.g., specific scaling or flags
     // For now, assume global scaling will be handled by the main batch function.
@@ -27,18 +27,19 @@ struct NfpBatchResultItem {
 // Calculates NFPs for a batch of tasks using multiple threads.
 // Parameters:
 // - tasks: A vector of NfpTaskItem, each defining a pair of polygons for NFP.
-// - results: Output vector to store the NFP result for each corresponding task.
-// - fixed_scale_for_boost_poly: The single scale factor to be used for all Boost.Polygon operations.
-// - DANGER_thread_count: Number of threads to use. 0 for default (e.g. hardware_concurrency).
-//                          The "DANGER_" prefix is because the original thread pool was global and might not be
-//                          safe to reconfigure per call easily. A new pool per call is safer.
-// Returns true if the batch processing was initiated successfully, false otherwise.
-// The actual success of each NFP is in NfpBatchResultItem.success.
+// - results: Output vector, resized to tasks.size(); results[i] belongs to tasks[i].
+// - fixed_scale_for_boost_poly: Passed to CalculateNfp for every task; <= 0 scales each pair on its own.
+// - requested_thread_count: Upper bound on the threads working on this batch, including the caller.
+//                           0 for default (QThreadPool::globalInstance()->maxThreadCount()).
+// The calling thread works through the tasks, helped by whichever threads of Qt's global pool
+// are idle when the batch starts; when the pool is busy (e.g. with fitness evaluations) the
+// caller runs the batch alone instead of adding threads or queueing behind other work.
+// Always returns true; the success of each NFP is in NfpBatchResultItem.success.
 bool CalculateNfp_Batch_MultiThreaded(
     const std::vector<NfpTaskItem>& tasks,
     std::vector<NfpBatchResultItem>& results,
     double fixed_scale_for_boost_poly,
-    int DANGER_requested_thread_count 
+    int requested_thread_count
 );
 
 } // namespace CustomMinkowski
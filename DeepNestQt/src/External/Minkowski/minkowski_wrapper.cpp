@@ -5,6 +5,9 @@
 #include <list>
 #include <algorithm> // For std::reverse if needed for orientation
 #include <limits>    // For std::numeric_limits
+#include <cmath>     // For std::fabs
+
+#include "minkowskiQuads.h" // For Geometry::MinkowskiQuads (edge-pair quads)
 
 // Boost.Polygon headers - ensure these are available in the include path during compilation
 #include <boost/polygon/polygon.hpp>
@@ -17,7 +20,6 @@
 typedef boost::polygon::point_data<int> BoostPoint; // Using int as per original module
 typedef boost::polygon::polygon_set_data<int> BoostPolygonSet;
 typedef boost::polygon::polygon_with_holes_data<int> BoostPolygonWithHoles;
-typedef std::pair<BoostPoint, BoostPoint> BoostEdge;
 
 // Using namespace for Boost.Polygon operators to match original style
 using namespace boost::polygon::operators;
@@ -28,52 +30,37 @@ namespace CustomMinkowski {
 // These are the core convolution functions from the original file.
 // They seem to be generic enough to be used directly with Boost.Polygon types.
 
-void convolve_two_segments(std::vector<BoostPoint>& figure, const BoostEdge& a, const BoostEdge& b) {
-  using namespace boost::polygon;
-  figure.clear();
-  figure.push_back(BoostPoint(a.first));
-  figure.push_back(BoostPoint(a.first));
-  figure.push_back(BoostPoint(a.second));
-  figure.push_back(BoostPoint(a.second));
-  convolve(figure[0], b.second);
-  convolve(figure[1], b.first);
-  convolve(figure[2], b.first);
-  convolve(figure[3], b.second);
+// The edge-pair quads of the convolution come from Geometry::MinkowskiQuads, which writes all of
+// them to one buffer; they are then inserted as vertex sequences after a single reserve, instead of
+// building a polygon per quad.
+typedef Geometry::MinkowskiQuads::Point32 PackedPoint;
+
+template <typename itrT>
+void pack_points(std::vector<PackedPoint>& packed, itrT b, itrT e) {
+  packed.clear();
+  for( ; b != e; ++b) {
+    packed.push_back(PackedPoint{boost::polygon::x(*b), boost::polygon::y(*b)});
+  }
 }
 
 template <typename itrT1, typename itrT2>
-void convolve_two_point_sequences(BoostPolygonSet& result, itrT1 ab, itrT1 ae, itrT2 bb, itrT2 be) {
-  using namespace boost::polygon;
+void convolve_two_point_sequences(std::vector<PackedPoint>& quads, itrT1 ab, itrT1 ae, itrT2 bb, itrT2 be) {
   if(ab == ae || bb == be)
     return;
-  //BoostPoint first_a = *ab; // Unused
-  BoostPoint prev_a = *ab;
-  std::vector<BoostPoint> vec;
-  BoostPolygonWithHoles poly; // Use BoostPolygonWithHoles here
-  ++ab;
-  for( ; ab != ae; ++ab) {
-    //BoostPoint first_b = *bb; // Unused
-    BoostPoint prev_b = *bb;
-    itrT2 tmpb = bb;
-    ++tmpb;
-    for( ; tmpb != be; ++tmpb) {
-      convolve_two_segments(vec, std::make_pair(prev_b, *tmpb), std::make_pair(prev_a, *ab));
-      set_points(poly, vec.begin(), vec.end());
-      result.insert(poly);
-      prev_b = *tmpb;
-    }
-    prev_a = *ab;
-  }
+  std::vector<PackedPoint> a, b;
+  pack_points(a, ab, ae);
+  pack_points(b, bb, be);
+  Geometry::MinkowskiQuads::append(a.data(), a.size(), b.data(), b.size(), quads);
 }
 
 template <typename itrT>
-void convolve_point_sequence_with_polygons(BoostPolygonSet& result, itrT b, itrT e, const std::vector<BoostPolygonWithHoles>& polygons) {
+void convolve_point_sequence_with_polygons(std::vector<PackedPoint>& quads, itrT b, itrT e, const std::vector<BoostPolygonWithHoles>& polygons) {
   using namespace boost::polygon;
   for(std::size_t i = 0; i < polygons.size(); ++i) {
-    convolve_two_point_sequences(result, b, e, begin_points(polygons[i]), end_points(polygons[i]));
+    convolve_two_point_sequences(quads, b, e, begin_points(polygons[i]), end_points(polygons[i]));
     for(polygon_with_holes_traits<BoostPolygonWithHoles>::iterator_holes_type itrh = begin_holes(polygons[i]);
         itrh != end_holes(polygons[i]); ++itrh) {
-      convolve_two_point_sequences(result, b, e, begin_points(*itrh), end_points(*itrh));
+      convolve_two_point_sequences(quads, b, e, begin_points(*itrh), end_points(*itrh));
     }
   }
 }
@@ -86,14 +73,25 @@ void convolve_two_polygon_sets(BoostPolygonSet& result, const BoostPolygonSet& p
   pa.get(a_polygons);
   pb.get(b_polygons);
 
+  std::vector<PackedPoint> quads;
   for(std::size_t ai = 0; ai < a_polygons.size(); ++ai) {
-    convolve_point_sequence_with_polygons(result, begin_points(a_polygons[ai]), 
+    convolve_point_sequence_with_polygons(quads, begin_points(a_polygons[ai]), 
                                           end_points(a_polygons[ai]), b_polygons);
     for(polygon_with_holes_traits<BoostPolygonWithHoles>::iterator_holes_type itrh = begin_holes(a_polygons[ai]);
         itrh != end_holes(a_polygons[ai]); ++itrh) {
-      convolve_point_sequence_with_polygons(result, begin_points(*itrh), 
+      convolve_point_sequence_with_polygons(quads, begin_points(*itrh), 
                                             end_points(*itrh), b_polygons);
     }
+  }
+  // Four edges per quad; the quads are counter-clockwise, as insert(polygon) would have found.
+  result.reserve(quads.size());
+  for(std::size_t k = 0; k + 4 <= quads.size(); k += 4) {
+    const BoostPoint corners[4] = {BoostPoint(quads[k].x, quads[k].y), BoostPoint(quads[k + 1].x, quads[k + 1].y),
+                                   BoostPoint(quads[k + 2].x, quads[k + 2].y), BoostPoint(quads[k + 3].x, quads[k + 3].y)};
+    result.insert_vertex_sequence(corners, corners + 4, COUNTERCLOCKWISE, false);
+  }
+
+  for(std::size_t ai = 0; ai < a_polygons.size(); ++ai) {
     for(std::size_t bi = 0; bi < b_polygons.size(); ++bi) {
       if (a_polygons[ai].begin() == a_polygons[ai].end() || b_polygons[bi].begin() == b_polygons[bi].end()) continue;
       BoostPolygonWithHoles tmp_poly = a_polygons[ai];
@@ -116,28 +114,52 @@ std::vector<BoostPoint> toBoostPoints(const PolygonPath& path, double scale) {
 }
 
 
+double AdaptiveScale(const PolygonWithHoles& partA_static, const PolygonWithHoles& partB_orbiting) {
+    // Bounds include the origin, as in the original module.
+    double aMinX = 0, aMaxX = 0, aMinY = 0, aMaxY = 0;
+    for (const Point& p : partA_static.outer) {
+        aMinX = std::min(aMinX, p.x); aMaxX = std::max(aMaxX, p.x);
+        aMinY = std::min(aMinY, p.y); aMaxY = std::max(aMaxY, p.y);
+    }
+    double bMinX = 0, bMaxX = 0, bMinY = 0, bMaxY = 0;
+    for (const Point& p : partB_orbiting.outer) {
+        bMinX = std::min(bMinX, p.x); bMaxX = std::max(bMaxX, p.x);
+        bMinY = std::min(bMinY, p.y); bMaxY = std::max(bMaxY, p.y);
+    }
+
+    // B is reflected, so the sum spans [aMin - bMax, aMax - bMin]. The original summed the
+    // unreflected bounds, which can underestimate this when B extends to negative coordinates.
+    const double maxX = std::max(std::fabs(aMaxX - bMinX), std::fabs(aMinX - bMaxX));
+    const double maxY = std::max(std::fabs(aMaxY - bMinY), std::fabs(aMinY - bMaxY));
+    double maxda = std::max(maxX, maxY);
+    if (maxda < 1) {
+        maxda = 1;
+    }
+    return (0.1 * static_cast<double>(std::numeric_limits<int>::max())) / maxda;
+}
+
 bool CalculateNfp(
-    const PolygonWithHoles& partA_orbiting, 
-    const PolygonWithHoles& partB_static,
+    const PolygonWithHoles& partA_static, 
+    const PolygonWithHoles& partB_orbiting,
     NfpResultPolygons& nfp_result,
     double fixed_scale_for_boost_poly) 
 {
     nfp_result.clear();
-    if (fixed_scale_for_boost_poly <= 0) {
-        // Invalid scale
-        return false; 
+    const double adaptive_scale = AdaptiveScale(partA_static, partB_orbiting);
+    if (fixed_scale_for_boost_poly <= 0 || fixed_scale_for_boost_poly > adaptive_scale) {
+        fixed_scale_for_boost_poly = adaptive_scale;
     }
 
     BoostPolygonSet boost_set_A, boost_set_B, boost_set_C_result;
 
-    // Convert partA_orbiting to BoostPolygonSet
-    if (!partA_orbiting.outer.empty()) {
-        std::vector<BoostPoint> outerA_pts = toBoostPoints(partA_orbiting.outer, fixed_scale_for_boost_poly);
+    // Convert partA_static to BoostPolygonSet
+    if (!partA_static.outer.empty()) {
+        std::vector<BoostPoint> outerA_pts = toBoostPoints(partA_static.outer, fixed_scale_for_boost_poly);
         BoostPolygonWithHoles polyA_outer;
         boost::polygon::set_points(polyA_outer, outerA_pts.begin(), outerA_pts.end());
         boost_set_A += polyA_outer;
 
-        for (const auto& hole_path : partA_orbiting.holes) {
+        for (const auto& hole_path : partA_static.holes) {
             if (!hole_path.empty()) {
                 std::vector<BoostPoint> holeA_pts = toBoostPoints(hole_path, fixed_scale_for_boost_poly);
                 BoostPolygonWithHoles polyA_hole;
@@ -147,27 +169,13 @@ bool CalculateNfp(
         }
     }
 
-    // Convert partB_static to BoostPolygonSet, applying reflection and shift logic
-    // The original code negates B's coordinates and stores the first point's original value as a shift.
-    // This is equivalent to reflecting B about its first point, then translating so that first point is at origin,
-    // then negating all coordinates (reflecting about origin).
-    // NFP(A, B) = A (+) Reflect(B about B_ref_point, then translate B_ref_point to origin)
-    // Or, if B's reference point is (0,0) for its coordinates: NFP = A (+) Reflect(B about origin)
-    
-    double xshift = 0, yshift = 0;
-    if (!partB_static.outer.empty()) {
-        xshift = partB_static.outer[0].x; // Capture shift from original first point of B
-        yshift = partB_static.outer[0].y;
-
+    // Convert partB_orbiting to BoostPolygonSet, reflected through its origin (its reference point),
+    // so the convolution is A (+) reflect(B). The original module then added B's first vertex to
+    // the result, which only fits the JS callers that move B's first vertex to the origin.
+    if (!partB_orbiting.outer.empty()) {
         PolygonPath reflected_outerB;
-        reflected_outerB.reserve(partB_static.outer.size());
-        for(const auto& p : partB_static.outer) {
-            // Reflect B: For NFP A(+)B, B is typically reflected about its reference point.
-            // If B's reference point is (0,0) in its local coords, then this is just (-x, -y).
-            // The original code did: x = -(inputscale * p.x); y = -(inputscale * p.y);
-            // And then added xshift, yshift to the result.
-            // This means the NFP is initially calculated for B reflected and at origin, then shifted.
-            // So, for input to Boost, we need B's points as (-p.x, -p.y) relative to B's origin.
+        reflected_outerB.reserve(partB_orbiting.outer.size());
+        for(const auto& p : partB_orbiting.outer) {
             reflected_outerB.push_back({-p.x, -p.y});
         }
         // Note: boost::polygon expects specific orientations (CW for holes, CCW for outer).
@@ -183,7 +191,7 @@ bool CalculateNfp(
         boost::polygon::set_points(polyB_outer, outerB_pts.begin(), outerB_pts.end());
         boost_set_B += polyB_outer;
 
-        for (const auto& hole_path_orig : partB_static.holes) {
+        for (const auto& hole_path_orig : partB_orbiting.holes) {
             if (!hole_path_orig.empty()) {
                 PolygonPath reflected_holeB;
                 reflected_holeB.reserve(hole_path_orig.size());
@@ -213,19 +221,32 @@ bool CalculateNfp(
         return true; // Technically successful, but no NFP produced (e.g. if one part is a point and other is empty)
     }
 
-    for(const auto& poly_wh : result_polys_with_holes) {
-        PolygonPath current_nfp_outer_path;
-        for(auto itr = poly_wh.begin(); itr != poly_wh.end(); ++itr) {
-            current_nfp_outer_path.push_back({
-                (static_cast<double>(itr->x()) / fixed_scale_for_boost_poly) + xshift,
-                (static_cast<double>(itr->y()) / fixed_scale_for_boost_poly) + yshift
+    // Each polygon is emitted as its outer ring followed by its holes. Outer rings are made
+    // counter-clockwise and holes clockwise, so a NonZero fill of the flat list is the NFP region.
+    auto appendRing = [&](auto begin, auto end, bool outer) {
+        PolygonPath path;
+        double area2 = 0;
+        for (auto itr = begin; itr != end; ++itr) {
+            path.push_back({
+                static_cast<double>(itr->x()) / fixed_scale_for_boost_poly,
+                static_cast<double>(itr->y()) / fixed_scale_for_boost_poly
             });
         }
-        // TODO: Handle holes in the NFP result if necessary.
-        // The current NfpResultPolygons type is std::list<PolygonPath>, so it doesn't store holes of the NFP.
-        // Most NFP applications use the outer boundary of the NFP.
-        if (!current_nfp_outer_path.empty()) {
-            nfp_result.push_back(current_nfp_outer_path);
+        if (path.size() < 3) {
+            return;
+        }
+        for (std::size_t i = 0, j = path.size() - 1; i < path.size(); j = i++) {
+            area2 += (path[j].x - path[i].x) * (path[j].y + path[i].y);
+        }
+        if ((area2 > 0) != outer) {
+            std::reverse(path.begin(), path.end());
+        }
+        nfp_result.push_back(path);
+    };
+    for(const auto& poly_wh : result_polys_with_holes) {
+        appendRing(poly_wh.begin(), poly_wh.end(), true);
+        for (auto hole = poly_wh.begin_holes(); hole != poly_wh.end_holes(); ++hole) {
+            appendRing(hole->begin(), hole->end(), false);
         }
     }
     
@@ -34,31 +34,31 @@ struct PolygonWithHoles {
 // These polygons are the boundaries of the No-Fit Polygon.
 typedef std::list<PolygonPath> NfpResultPolygons;
 
-// Calculates NFP of A (orbiting part) around B (static part).
-// The NFP represents the boundary of all locations B's reference point can take
-// such that A and B do not overlap.
-// Or, more commonly for nesting: NFP represents the boundary of A's reference point
-// as it slides around B.
-// The implementation will need to handle the coordinate transformations and scaling
-// identified in the analysis of the original minkowski.cc.
+// Largest scale that keeps every coordinate of the convolution of A and reflect(B) within
+// 0.1 * INT_MAX, the headroom the original module found safe for Boost.Polygon's int arithmetic.
+double AdaptiveScale(const PolygonWithHoles& partA_static, const PolygonWithHoles& partB_orbiting);
+
+// Calculates the NFP of B (orbiting part) around A (static part), in the JS convention of the
+// original module: the static part comes first. The result is A (+) reflect(B), the positions of
+// B's reference point (its origin) where B touches or overlaps A, in A's coordinates; the same
+// region as NfpGenerator::minkowskiNfp. Holes of either part are kept as holes of the result.
 //
 // Parameters:
-// - partA_orbiting: The polygon that is considered to be moving or "orbiting".
-// - partB_static: The polygon that is considered static.
-// - nfp_result: Output parameter to store the resulting NFP polygons.
-// - input_scale_override: Optional. If > 0, this scale is used instead of dynamic calculation.
-//                         This might be useful for consistency with other geometry operations.
-//                         If <= 0, the function might use its internal dynamic scaling logic.
-//                         (This is a design choice for the wrapper).
+// - partA_static: The polygon that is considered static.
+// - partB_orbiting: The polygon that is considered to be moving or "orbiting".
+// - nfp_result: Output parameter to store the resulting NFP polygons: every outer ring
+//               counter-clockwise, followed by its holes clockwise.
+// - fixed_scale_for_boost_poly: Scale converting the doubles to Boost.Polygon's int coordinates.
+//                               If <= 0, the scale is chosen per pair as in the original minkowski.cc:
+//                               0.1 * INT_MAX over the largest coordinate the convolution can reach.
+//                               A fixed scale that would overflow that bound is lowered to it.
 //
 // Returns true on success, false on failure or if NFP is empty/invalid.
 bool CalculateNfp(
-    const PolygonWithHoles& partA_orbiting, 
-    const PolygonWithHoles& partB_static,
+    const PolygonWithHoles& partA_static,
+    const PolygonWithHoles& partB_orbiting,
     NfpResultPolygons& nfp_result,
-    double fixed_scale_for_boost_poly // The scale factor to convert doubles to integers for Boost.Polygon
-    // Consider adding a parameter for `use_holes` if the original logic supports it differently
-    // or if sometimes we want NFP of just outer boundaries. For now, assume holes are always processed.
+    double fixed_scale_for_boost_poly // The scale factor to convert doubles to integers for Boost.Polygon, <= 0 for per-pair
 );
 
 } // namespace CustomMinkowski
@@ -0,0 +1,253 @@
+#include "batchPointInPolygon.h"
+#include <algorithm> // For std::min, std::max, std::minmax, std::min_element, std::max_element
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#define BATCH_POINT_IN_POLYGON_AVX2
+#endif
+
+namespace Geometry {
+
+namespace {
+
+const std::size_t kBlock = 4; // Points per group, one AVX2 register of doubles
+
+bool filled(int winding, Clipper2Lib::FillRule fillRule) {
+    switch (fillRule) {
+    case Clipper2Lib::FillRule::EvenOdd: return (winding & 1) != 0;
+    case Clipper2Lib::FillRule::NonZero: return winding != 0;
+    case Clipper2Lib::FillRule::Positive: return winding > 0;
+    case Clipper2Lib::FillRule::Negative: return winding < 0;
+    }
+    return false;
+}
+
+} // namespace
+
+BatchPointInPolygon::BatchPointInPolygon(const Clipper2Lib::Paths64& region) {
+    std::vector<std::pair<Clipper2Lib::Point64, Clipper2Lib::Point64>> edges;
+    for (const Clipper2Lib::Path64& ring : region) {
+        if (ring.size() < 3) continue;
+        const Clipper2Lib::Rect64 ringBounds = Clipper2Lib::GetBounds(ring);
+        if (edges.empty()) {
+            bounds_ = ringBounds;
+        } else {
+            bounds_.left = std::min(bounds_.left, ringBounds.left);
+            bounds_.top = std::min(bounds_.top, ringBounds.top);
+            bounds_.right = std::max(bounds_.right, ringBounds.right);
+            bounds_.bottom = std::max(bounds_.bottom, ringBounds.bottom);
+        }
+        for (std::size_t i = 0; i < ring.size(); ++i) {
+            edges.emplace_back(ring[i], ring[i + 1 < ring.size() ? i + 1 : 0]);
+        }
+    }
+    if (edges.empty()) return;
+
+    // About four edges per band; each band is at least one unit high.
+    const int64_t height = bounds_.bottom - bounds_.top;
+    const std::size_t bandCount = static_cast<std::size_t>(
+        std::max<int64_t>(1, std::min<int64_t>(static_cast<int64_t>(edges.size() / 4), height + 1)));
+    bandHeight_ = height / static_cast<int64_t>(bandCount) + 1;
+
+    bandStart_.assign(bandCount + 1, 0);
+    for (const auto& edge : edges) {
+        const auto ys = std::minmax(edge.first.y, edge.second.y);
+        for (std::size_t band = bandOf(ys.first); band <= bandOf(ys.second); ++band) ++bandStart_[band + 1];
+    }
+    for (std::size_t band = 0; band < bandCount; ++band) bandStart_[band + 1] += bandStart_[band];
+    const std::size_t slots = bandStart_.back();
+    for (std::vector<double>* column : {&x0_, &y0_, &dx_, &dy_, &xMin_, &xMax_, &yMin_, &yMax_}) column->resize(slots);
+
+    std::vector<std::size_t> next(bandStart_.begin(), bandStart_.end() - 1);
+    for (const auto& edge : edges) {
+        const Clipper2Lib::Point64& a = edge.first;
+        const Clipper2Lib::Point64& b = edge.second;
+        const auto xs = std::minmax(a.x, b.x);
+        const auto ys = std::minmax(a.y, b.y);
+        for (std::size_t band = bandOf(ys.first); band <= bandOf(ys.second); ++band) {
+            const std::size_t i = next[band]++;
+            x0_[i] = static_cast<double>(a.x);
+            y0_[i] = static_cast<double>(a.y);
+            dx_[i] = static_cast<double>(b.x - a.x);
+            dy_[i] = static_cast<double>(b.y - a.y);
+            xMin_[i] = static_cast<double>(xs.first);
+            xMax_[i] = static_cast<double>(xs.second);
+            yMin_[i] = static_cast<double>(ys.first);
+            yMax_[i] = static_cast<double>(ys.second);
+        }
+    }
+}
+
+std::size_t BatchPointInPolygon::bandOf(int64_t y) const {
+    return static_cast<std::size_t>((y - bounds_.top) / bandHeight_);
+}
+
+void BatchPointInPolygon::locate(const Clipper2Lib::Point64* points, std::size_t count, Clipper2Lib::FillRule fillRule,
+                                 Clipper2Lib::PointInPolygonResult* results) const {
+    // Bounds rejection, then the remaining points are grouped by band (counting sort) and packed
+    // as x and y arrays, each band's run padded to whole groups by repeating its last point.
+    const std::size_t bandCount = bandStart_.empty() ? 0 : bandStart_.size() - 1;
+    std::vector<std::size_t> bandPoints(bandCount + 1, 0);
+    for (std::size_t i = 0; i < count; ++i) {
+        results[i] = Clipper2Lib::PointInPolygonResult::IsOutside;
+        const Clipper2Lib::Point64& p = points[i];
+        if (isEmpty() || p.x < bounds_.left || p.x > bounds_.right || p.y < bounds_.top || p.y > bounds_.bottom) continue;
+        ++bandPoints[bandOf(p.y) + 1];
+    }
+    std::size_t packedCount = 0;
+    for (std::size_t band = 0; band < bandCount; ++band) {
+        const std::size_t run = bandPoints[band + 1];
+        bandPoints[band] = packedCount; // Next free slot of the band
+        packedCount += (run + kBlock - 1) / kBlock * kBlock;
+    }
+    if (packedCount == 0) return;
+
+    const std::size_t padding = static_cast<std::size_t>(-1);
+    std::vector<std::size_t> indices(packedCount, padding); // Point of each packed slot
+    std::vector<double> xs(packedCount), ys(packedCount);
+    std::vector<std::size_t> blockBands(packedCount / kBlock);
+    for (std::size_t i = 0; i < count; ++i) {
+        const Clipper2Lib::Point64& p = points[i];
+        if (p.x < bounds_.left || p.x > bounds_.right || p.y < bounds_.top || p.y > bounds_.bottom) continue;
+        const std::size_t band = bandOf(p.y);
+        const std::size_t slot = bandPoints[band]++;
+        indices[slot] = i;
+        xs[slot] = static_cast<double>(p.x);
+        ys[slot] = static_cast<double>(p.y);
+        blockBands[slot / kBlock] = band;
+    }
+    for (std::size_t slot = 1; slot < packedCount; ++slot) {
+        if (indices[slot] != padding) continue;
+        xs[slot] = xs[slot - 1];
+        ys[slot] = ys[slot - 1];
+    }
+
+    // Winding number (Sunday): an edge crossing the point's row upwards with the point on its left
+    // adds one, downwards with the point on its right takes one. Rows are half-open at the top,
+    // so a vertex on the row is counted once; positive (counter-clockwise) rings wind +1.
+    for (std::size_t k = 0; k < xs.size(); k += kBlock) {
+        const std::size_t band = blockBands[k / kBlock];
+        const double blockTop = *std::min_element(ys.begin() + k, ys.begin() + k + kBlock);
+        const double blockBottom = *std::max_element(ys.begin() + k, ys.begin() + k + kBlock);
+        int winding[kBlock] = {0, 0, 0, 0};
+        bool on[kBlock] = {false, false, false, false};
+
+#if defined(BATCH_POINT_IN_POLYGON_AVX2)
+        const __m256d px = _mm256_loadu_pd(&xs[k]);
+        const __m256d py = _mm256_loadu_pd(&ys[k]);
+        const __m256d zero = _mm256_setzero_pd();
+        const __m256d one = _mm256_set1_pd(1.0);
+        __m256d windingSum = zero;
+        __m256d onMask = zero;
+#endif
+        for (std::size_t e = bandStart_[band]; e < bandStart_[band + 1]; ++e) {
+            if (blockBottom < yMin_[e] || blockTop > yMax_[e]) continue;
+#if defined(BATCH_POINT_IN_POLYGON_AVX2)
+            const __m256d yMin = _mm256_set1_pd(yMin_[e]);
+            const __m256d yMax = _mm256_set1_pd(yMax_[e]);
+            const __m256d cross = _mm256_sub_pd(
+                _mm256_mul_pd(_mm256_set1_pd(dx_[e]), _mm256_sub_pd(py, _mm256_set1_pd(y0_[e]))),
+                _mm256_mul_pd(_mm256_sub_pd(px, _mm256_set1_pd(x0_[e])), _mm256_set1_pd(dy_[e])));
+            const __m256d inY = _mm256_and_pd(_mm256_cmp_pd(py, yMin, _CMP_GE_OQ), _mm256_cmp_pd(py, yMax, _CMP_LE_OQ));
+            const __m256d inX = _mm256_and_pd(_mm256_cmp_pd(px, _mm256_set1_pd(xMin_[e]), _CMP_GE_OQ),
+                                              _mm256_cmp_pd(px, _mm256_set1_pd(xMax_[e]), _CMP_LE_OQ));
+            onMask = _mm256_or_pd(onMask, _mm256_and_pd(_mm256_cmp_pd(cross, zero, _CMP_EQ_OQ), _mm256_and_pd(inX, inY)));
+            const __m256d crosses = _mm256_and_pd(_mm256_cmp_pd(py, yMin, _CMP_GE_OQ), _mm256_cmp_pd(py, yMax, _CMP_LT_OQ));
+            if (dy_[e] > 0) {
+                const __m256d left = _mm256_and_pd(crosses, _mm256_cmp_pd(cross, zero, _CMP_GT_OQ));
+                windingSum = _mm256_add_pd(windingSum, _mm256_and_pd(left, one));
+            } else if (dy_[e] < 0) {
+                const __m256d right = _mm256_and_pd(crosses, _mm256_cmp_pd(cross, zero, _CMP_LT_OQ));
+                windingSum = _mm256_sub_pd(windingSum, _mm256_and_pd(right, one));
+            }
+#else
+            for (std::size_t j = 0; j < kBlock; ++j) {
+                const double px = xs[k + j], py = ys[k + j];
+                if (py < yMin_[e] || py > yMax_[e]) continue;
+                const double cross = dx_[e] * (py - y0_[e]) - (px - x0_[e]) * dy_[e];
+                if (cross == 0 && px >= xMin_[e] && px <= xMax_[e]) on[j] = true;
+                if (py == yMax_[e]) continue;
+                if (dy_[e] > 0 && cross > 0) ++winding[j];
+                else if (dy_[e] < 0 && cross < 0) --winding[j];
+            }
+#endif
+        }
+#if defined(BATCH_POINT_IN_POLYGON_AVX2)
+        double windingLanes[kBlock];
+        _mm256_storeu_pd(windingLanes, windingSum);
+        const int onBits = _mm256_movemask_pd(onMask);
+        for (std::size_t j = 0; j < kBlock; ++j) {
+            winding[j] = static_cast<int>(windingLanes[j]);
+            on[j] = (onBits >> j) & 1;
+        }
+#endif
+
+        for (std::size_t j = 0; j < kBlock; ++j) {
+            if (indices[k + j] == padding) continue;
+            results[indices[k + j]] = on[j] ? locateOnEdge(xs[k + j], ys[k + j], band, fillRule)
+                                    : filled(winding[j], fillRule) ? Clipper2Lib::PointInPolygonResult::IsInside
+                                                                   : Clipper2Lib::PointInPolygonResult::IsOutside;
+        }
+    }
+}
+
+int BatchPointInPolygon::windingNear(double px, double py, double ax, double ay, double bx, double by,
+                                     std::size_t band) const {
+    // Winding number at q = p + t * a + t^2 * b for an infinitesimal t > 0: every comparison with
+    // q is decided by p, then by a, then by b. Every edge whose y range reaches p's row
+    // is listed in p's band.
+    auto sign = [](double value) { return (value > 0) - (value < 0); };
+    auto compareY = [&](double y) { // Sign of (qy - y)
+        const int bySelf = sign(py - y);
+        return bySelf != 0 ? bySelf : sign(ay) != 0 ? sign(ay) : sign(by);
+    };
+    int winding = 0;
+    for (std::size_t e = bandStart_[band]; e < bandStart_[band + 1]; ++e) {
+        if (dy_[e] == 0 || compareY(yMin_[e]) < 0 || compareY(yMax_[e]) >= 0) continue;
+        int cross = sign(dx_[e] * (py - y0_[e]) - (px - x0_[e]) * dy_[e]);
+        if (cross == 0) cross = sign(dx_[e] * ay - ax * dy_[e]);
+        if (cross == 0) cross = sign(dx_[e] * by - bx * dy_[e]);
+        if (dy_[e] > 0 && cross > 0) ++winding;
+        else if (dy_[e] < 0 && cross < 0) --winding;
+    }
+    return winding;
+}
+
+Clipper2Lib::PointInPolygonResult BatchPointInPolygon::locateOnEdge(double px, double py, std::size_t band,
+                                                                    Clipper2Lib::FillRule fillRule) const {
+    // The point is on the boundary of the filled region only if the fill differs somewhere around
+    // it; on an edge shared by two tiles, or inside another ring, it is not. Every sector around
+    // the point is bounded by an edge through it, so the fill is sampled on both sides of each
+    // such edge: along the edge away from the point, then just off it.
+    bool anyFilled = false, anyEmpty = false;
+    for (std::size_t e = bandStart_[band]; e < bandStart_[band + 1]; ++e) {
+        if (py < yMin_[e] || py > yMax_[e] || px < xMin_[e] || px > xMax_[e]) continue;
+        if (dx_[e] * (py - y0_[e]) - (px - x0_[e]) * dy_[e] != 0) continue;
+        // Along the edge away from the point: towards its end, or back towards its start at the end.
+        const bool atEnd = px == x0_[e] + dx_[e] && py == y0_[e] + dy_[e];
+        const double sx = atEnd ? -dx_[e] : dx_[e], sy = atEnd ? -dy_[e] : dy_[e];
+        if (sx == 0 && sy == 0) continue;
+        for (int side : {1, -1}) {
+            const bool isFilled = filled(windingNear(px, py, sx, sy, -sy * side, sx * side, band), fillRule);
+            (isFilled ? anyFilled : anyEmpty) = true;
+        }
+        if (anyFilled && anyEmpty) return Clipper2Lib::PointInPolygonResult::IsOn;
+    }
+    return anyFilled ? Clipper2Lib::PointInPolygonResult::IsInside : Clipper2Lib::PointInPolygonResult::IsOutside;
+}
+
+void BatchPointInPolygon::locate(const Clipper2Lib::Path64& points, Clipper2Lib::FillRule fillRule,
+                                 std::vector<Clipper2Lib::PointInPolygonResult>& results) const {
+    results.resize(points.size());
+    locate(points.data(), points.size(), fillRule, results.data());
+}
+
+const char* BatchPointInPolygon::kernelName() {
+#if defined(BATCH_POINT_IN_POLYGON_AVX2)
+    return "avx2";
+#else
+    return "scalar";
+#endif
+}
+
+} // namespace Geometry
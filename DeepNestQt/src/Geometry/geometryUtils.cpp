@@ -1,8 +1,14 @@
 #include "geometryUtils.h"
+#include "HullPolygon.h" // For Geometry::HullPolygon (convexity test)
+#include "minkowskiQuads.h" // For Geometry::MinkowskiQuads (edge-pair quads of the region sums)
 #include <cmath>      // For M_PI, std::abs
 #include <limits>     // For std::numeric_limits
 #include <QRectF>     // Included via QPolygonF but good for clarity
 #include <QPainterPath> // For more robust point-in-polygon if QPolygonF's is not sufficient
+#include <QVector>
+#include <QPair>
+#include <algorithm>  // For std::sort
+#include <QtMath>     // For qDegreesToRadians
 
 namespace GeometryUtils {
 
@@ -81,4 +87,520 @@ namespace GeometryUtils {
         }
     }
 
+    namespace {
+        const quint64 kFnvOffsetBasis = 14695981039346656037ULL;
+        const quint64 kFnvPrime = 1099511628211ULL;
+
+        typedef QPair<qint64, qint64> GridPoint;
+
+        void fnvAppend(quint64& hash, qint64 value) {
+            for (int i = 0; i < 8; ++i) {
+                hash ^= static_cast<quint64>(value >> (i * 8)) & 0xFFULL;
+                hash *= kFnvPrime;
+            }
+        }
+
+        // Snaps the ring to the grid and drops repeated vertices, including a closing
+        // vertex equal to the first one.
+        QVector<GridPoint> quantizeRing(const QPolygonF& ring, double quantum) {
+            QVector<GridPoint> points;
+            points.reserve(ring.size());
+            for (const QPointF& p : ring) {
+                const GridPoint g(qRound64(p.x() / quantum), qRound64(p.y() / quantum));
+                if (points.isEmpty() || points.last() != g) {
+                    points.append(g);
+                }
+            }
+            while (points.size() > 1 && points.first() == points.last()) {
+                points.removeLast();
+            }
+            return points;
+        }
+
+        // Start index of the lexicographically smallest rotation of the cyclic sequence.
+        int canonicalStart(const QVector<GridPoint>& points) {
+            const int n = points.size();
+            int best = 0;
+            for (int i = 1; i < n; ++i) {
+                if (points[best] < points[i]) continue;
+                if (points[i] < points[best]) { best = i; continue; }
+                for (int k = 1; k < n; ++k) { // Same vertex twice: compare the whole rotations
+                    const GridPoint& a = points[(i + k) % n];
+                    const GridPoint& b = points[(best + k) % n];
+                    if (a < b) { best = i; break; }
+                    if (b < a) break;
+                }
+            }
+            return best;
+        }
+
+        quint64 ringFingerprint(const QPolygonF& ring, double quantum) {
+            const QVector<GridPoint> points = quantizeRing(ring, quantum);
+            const int n = points.size();
+            const int start = canonicalStart(points);
+            quint64 hash = kFnvOffsetBasis;
+            fnvAppend(hash, n);
+            for (int k = 0; k < n; ++k) {
+                const GridPoint& p = points[(start + k) % n];
+                fnvAppend(hash, p.first);
+                fnvAppend(hash, p.second);
+            }
+            return hash;
+        }
+    }
+
+    quint64 geometryFingerprint(const QPolygonF& outer, const QList<QPolygonF>& holes, double quantum) {
+        quint64 hash = ringFingerprint(outer, quantum);
+        // Holes are an unordered set.
+        QVector<quint64> holeHashes;
+        holeHashes.reserve(holes.size());
+        for (const QPolygonF& hole : holes) {
+            holeHashes.append(ringFingerprint(hole, quantum));
+        }
+        std::sort(holeHashes.begin(), holeHashes.end());
+        fnvAppend(hash, holeHashes.size());
+        for (quint64 holeHash : holeHashes) {
+            fnvAppend(hash, static_cast<qint64>(holeHash));
+        }
+        return hash != 0 ? hash : 1; // 0 is reserved for "no fingerprint"
+    }
+
+    Clipper2Lib::Point64 toPoint64(const QPointF& point, double scale) {
+        return Clipper2Lib::Point64(qRound64(point.x() * scale), qRound64(point.y() * scale));
+    }
+
+    Clipper2Lib::Path64 toPath64(const QPolygonF& polygon, double scale) {
+        Clipper2Lib::Path64 path;
+        path.reserve(polygon.size());
+        for (const QPointF& pt : polygon) {
+            path.push_back(toPoint64(pt, scale));
+        }
+        return path;
+    }
+
+    Clipper2Lib::Paths64 toPaths64(const QList<QPolygonF>& polygons, double scale) {
+        Clipper2Lib::Paths64 paths;
+        paths.reserve(polygons.size());
+        for (const QPolygonF& polygon : polygons) {
+            if (!polygon.isEmpty()) {
+                paths.push_back(toPath64(polygon, scale));
+            }
+        }
+        return paths;
+    }
+
+    QPointF fromPoint64(const Clipper2Lib::Point64& point, double scale) {
+        return QPointF(static_cast<double>(point.x) / scale, static_cast<double>(point.y) / scale);
+    }
+
+    QPolygonF fromPath64(const Clipper2Lib::Path64& path, double scale) {
+        QPolygonF polygon;
+        polygon.reserve(static_cast<int>(path.size()));
+        for (const Clipper2Lib::Point64& pt : path) {
+            polygon.append(fromPoint64(pt, scale));
+        }
+        return polygon;
+    }
+
+    QList<QPolygonF> fromPaths64(const Clipper2Lib::Paths64& paths, double scale) {
+        QList<QPolygonF> polygons;
+        polygons.reserve(static_cast<int>(paths.size()));
+        for (const Clipper2Lib::Path64& path : paths) {
+            if (!path.empty()) {
+                polygons.append(fromPath64(path, scale));
+            }
+        }
+        return polygons;
+    }
+
+    void rotationFactors(double degrees, double& cosA, double& sinA) {
+        double normalized = std::fmod(degrees, 360.0);
+        if (normalized < 0) normalized += 360.0;
+        if (normalized == 0.0)        { cosA = 1.0;  sinA = 0.0; }
+        else if (normalized == 90.0)  { cosA = 0.0;  sinA = 1.0; }
+        else if (normalized == 180.0) { cosA = -1.0; sinA = 0.0; }
+        else if (normalized == 270.0) { cosA = 0.0;  sinA = -1.0; }
+        else {
+            const double radians = qDegreesToRadians(normalized);
+            cosA = std::cos(radians);
+            sinA = std::sin(radians);
+        }
+    }
+
+    Clipper2Lib::Point64 rotatePoint64(const Clipper2Lib::Point64& point, double cosA, double sinA) {
+        const double x = static_cast<double>(point.x);
+        const double y = static_cast<double>(point.y);
+        return Clipper2Lib::Point64(qRound64(cosA * x - sinA * y), qRound64(sinA * x + cosA * y));
+    }
+
+    Clipper2Lib::Path64 rotatePath64(const Clipper2Lib::Path64& path, double degrees) {
+        double cosA, sinA;
+        rotationFactors(degrees, cosA, sinA);
+        if (cosA == 1.0) return path;
+        Clipper2Lib::Path64 rotated;
+        rotated.reserve(path.size());
+        for (const Clipper2Lib::Point64& pt : path) {
+            rotated.push_back(rotatePoint64(pt, cosA, sinA));
+        }
+        return rotated;
+    }
+
+    bool isConvex(const QPolygonF& polygon, double relativeTolerance /* = 1e-9 */) {
+        if (polygon.size() < 3) return false;
+        const double polygonArea = area(polygon);
+        if (polygonArea <= 0.0) return false;
+        const double hullArea = area(Geometry::HullPolygon::convexHull(polygon));
+        return std::abs(hullArea - polygonArea) <= relativeTolerance * hullArea;
+    }
+
+    // Vertices of a (nearly) convex path, counter-clockwise from its lowest, leftmost vertex,
+    // keeping only strict left turns. One stack pass, as in the monotone chain hull.
+    static Clipper2Lib::Path64 normalizedConvexPath(const Clipper2Lib::Path64& path) {
+        const size_t n = path.size();
+        Clipper2Lib::Path64 result;
+        if (n < 3) return result;
+
+        const bool reversed = Clipper2Lib::Area(path) < 0;
+        size_t start = 0;
+        for (size_t i = 1; i < n; ++i) {
+            if (path[i].y < path[start].y || (path[i].y == path[start].y && path[i].x < path[start].x)) {
+                start = i;
+            }
+        }
+
+        result.reserve(n);
+        for (size_t k = 0; k < n; ++k) {
+            const Clipper2Lib::Point64& p = path[reversed ? (start + n - k) % n : (start + k) % n];
+            while (result.size() >= 2 &&
+                   Clipper2Lib::CrossProductSign(result[result.size() - 2], result.back(), p) <= 0) {
+                result.pop_back();
+            }
+            if (result.empty() || result.back() != p) result.push_back(p);
+        }
+        // Close the ring: the start vertex is extreme, so only the tail can turn the wrong way.
+        while (result.size() >= 3 &&
+               Clipper2Lib::CrossProductSign(result[result.size() - 2], result.back(), result.front()) <= 0) {
+            result.pop_back();
+        }
+        if (result.size() < 3) result.clear();
+        return result;
+    }
+
+    Clipper2Lib::Path64 minkowskiSumConvex(const Clipper2Lib::Path64& a, const Clipper2Lib::Path64& b) {
+        const Clipper2Lib::Path64 p = normalizedConvexPath(a);
+        const Clipper2Lib::Path64 q = normalizedConvexPath(b);
+        if (p.empty() || q.empty()) return Clipper2Lib::Path64();
+
+        // Both rings start at their lowest vertex, so their edges are already sorted by angle in
+        // [0, 2pi); the sum starts at the sum of those vertices and takes the smaller-angle edge next.
+        const Clipper2Lib::Point64 origin(0, 0);
+        const size_t n = p.size();
+        const size_t m = q.size();
+        Clipper2Lib::Path64 result;
+        result.reserve(n + m);
+        size_t i = 0;
+        size_t j = 0;
+        while (i < n || j < m) {
+            result.push_back(p[i % n] + q[j % m]);
+            int turn;
+            if (i == n) {
+                turn = -1;
+            } else if (j == m) {
+                turn = 1;
+            } else {
+                const Clipper2Lib::Point64 edgeP = p[(i + 1) % n] - p[i];
+                const Clipper2Lib::Point64 edgeQ = q[(j + 1) % m] - q[j];
+                turn = Clipper2Lib::CrossProductSign(origin, edgeP, edgeP + edgeQ); // sign of edgeP x edgeQ
+            }
+            if (turn >= 0) ++i; // edgeP comes first (or both are parallel)
+            if (turn <= 0) ++j;
+        }
+        return result;
+    }
+
+    // Inclusive test against a counter-clockwise triangle.
+    static bool isPointInTriangle(const Clipper2Lib::Point64& p, const Clipper2Lib::Point64& a,
+                                  const Clipper2Lib::Point64& b, const Clipper2Lib::Point64& c) {
+        return Clipper2Lib::CrossProductSign(a, b, p) >= 0 &&
+               Clipper2Lib::CrossProductSign(b, c, p) >= 0 &&
+               Clipper2Lib::CrossProductSign(c, a, p) >= 0;
+    }
+
+    // Position of the directed edge from -> to in a piece, or -1.
+    static int findEdge(const std::vector<int>& piece, int from, int to) {
+        const int size = static_cast<int>(piece.size());
+        for (int k = 0; k < size; ++k) {
+            if (piece[k] == from && piece[(k + 1) % size] == to) return k;
+        }
+        return -1;
+    }
+
+    Clipper2Lib::Paths64 convexDecomposition(const Clipper2Lib::Path64& path) {
+        Clipper2Lib::Path64 ring = Clipper2Lib::TrimCollinear(path, false);
+        if (ring.size() < 3) return Clipper2Lib::Paths64();
+        if (Clipper2Lib::Area(ring) < 0) std::reverse(ring.begin(), ring.end());
+        const int n = static_cast<int>(ring.size());
+
+        auto isReflex = [&](int a, int b, int c) {
+            return Clipper2Lib::CrossProductSign(ring[a], ring[b], ring[c]) <= 0;
+        };
+
+        // Ear clipping over a doubly linked ring of vertex indices.
+        std::vector<int> prev(n), next(n);
+        for (int i = 0; i < n; ++i) {
+            prev[i] = (i + n - 1) % n;
+            next[i] = (i + 1) % n;
+        }
+        bool convex = true;
+        for (int i = 0; i < n && convex; ++i) {
+            convex = !isReflex(prev[i], i, next[i]);
+        }
+        if (convex) return Clipper2Lib::Paths64{ring};
+
+        std::vector<std::vector<int>> pieces;
+        std::vector<std::pair<int, int>> diagonals;
+        pieces.reserve(n - 2);
+        diagonals.reserve(n - 3);
+        int remaining = n;
+        int current = 0;
+        int sinceLastEar = 0;
+        while (remaining > 3) {
+            const int a = prev[current];
+            const int c = next[current];
+            bool ear = !isReflex(a, current, c);
+            if (ear) {
+                // Only reflex vertices can lie inside an ear.
+                for (int j = next[c]; j != a; j = next[j]) {
+                    if (isReflex(prev[j], j, next[j]) && ring[j] != ring[a] && ring[j] != ring[current] &&
+                        ring[j] != ring[c] && isPointInTriangle(ring[j], ring[a], ring[current], ring[c])) {
+                        ear = false;
+                        break;
+                    }
+                }
+            }
+            if (ear) {
+                pieces.push_back({a, current, c});
+                diagonals.push_back({a, c});
+                next[a] = c;
+                prev[c] = a;
+                --remaining;
+                sinceLastEar = 0;
+                current = c;
+            } else {
+                current = c;
+                if (++sinceLastEar > remaining) return Clipper2Lib::Paths64(); // No ear left: not simple
+            }
+        }
+        pieces.push_back({prev[current], current, next[current]});
+
+        // Hertel-Mehlhorn: drop a diagonal when the two pieces it separates merge into a convex one.
+        std::vector<bool> alive(pieces.size(), true);
+        for (const std::pair<int, int>& diagonal : diagonals) {
+            const int u = diagonal.first;
+            const int v = diagonal.second;
+            int p = -1, q = -1, pEdge = -1, qEdge = -1;
+            for (int k = 0; k < static_cast<int>(pieces.size()) && (p < 0 || q < 0); ++k) {
+                if (!alive[k]) continue;
+                if (p < 0 && (pEdge = findEdge(pieces[k], u, v)) >= 0) p = k;
+                else if (q < 0 && (qEdge = findEdge(pieces[k], v, u)) >= 0) q = k;
+            }
+            if (p < 0 || q < 0) continue;
+
+            // Rotate P to run v ... u and Q to run u ... v, then join them without repeating u and v.
+            const std::vector<int>& pieceP = pieces[p];
+            const std::vector<int>& pieceQ = pieces[q];
+            const int sizeP = static_cast<int>(pieceP.size());
+            const int sizeQ = static_cast<int>(pieceQ.size());
+            std::vector<int> merged;
+            merged.reserve(sizeP + sizeQ - 2);
+            for (int k = 1; k <= sizeP; ++k) merged.push_back(pieceP[(pEdge + k) % sizeP]);
+            for (int k = 2; k < sizeQ; ++k) merged.push_back(pieceQ[(qEdge + k) % sizeQ]);
+
+            const int m = static_cast<int>(merged.size());
+            const int uPos = sizeP - 1;
+            // Collinear joins are fine, the convex kernel drops those vertices.
+            if (Clipper2Lib::CrossProductSign(ring[merged[uPos - 1]], ring[u], ring[merged[(uPos + 1) % m]]) < 0 ||
+                Clipper2Lib::CrossProductSign(ring[merged[m - 1]], ring[v], ring[merged[1]]) < 0) {
+                continue;
+            }
+            pieces[p] = std::move(merged);
+            alive[q] = false;
+        }
+
+        Clipper2Lib::Paths64 result;
+        for (size_t k = 0; k < pieces.size(); ++k) {
+            if (!alive[k]) continue;
+            Clipper2Lib::Path64 piece;
+            piece.reserve(pieces[k].size());
+            for (int index : pieces[k]) piece.push_back(ring[index]);
+            result.push_back(std::move(piece));
+        }
+        return result;
+    }
+
+    Clipper2Lib::Paths64 orientedRegion(const Clipper2Lib::Path64& outer, const Clipper2Lib::Paths64& holes) {
+        Clipper2Lib::Paths64 region;
+        if (outer.size() < 3) return region;
+        region.reserve(holes.size() + 1);
+        region.push_back(outer);
+        if (Clipper2Lib::Area(region.back()) < 0) std::reverse(region.back().begin(), region.back().end());
+        for (const Clipper2Lib::Path64& hole : holes) {
+            if (hole.size() < 3) continue;
+            region.push_back(hole);
+            if (Clipper2Lib::Area(region.back()) > 0) std::reverse(region.back().begin(), region.back().end());
+        }
+        return region;
+    }
+
+    static Clipper2Lib::Paths64 reflectRegion(const Clipper2Lib::Paths64& region) {
+        Clipper2Lib::Paths64 reflected;
+        reflected.reserve(region.size());
+        for (const Clipper2Lib::Path64& ring : region) {
+            Clipper2Lib::Path64 path;
+            path.reserve(ring.size());
+            for (const Clipper2Lib::Point64& p : ring) path.push_back(Clipper2Lib::Point64(-p.x, -p.y));
+            reflected.push_back(std::move(path)); // Point reflection keeps the orientation
+        }
+        return reflected;
+    }
+
+    // Appends the edge-pair quads of every pair of rings (both closed), left for the caller's single
+    // union instead of one union per pair as Clipper2's MinkowskiSum does, and one copy of 'b' at the
+    // first vertex of every ring of 'a'.
+    static void appendBoundarySum(const Clipper2Lib::Paths64& a, const Clipper2Lib::Paths64& b, Clipper2Lib::Paths64& out) {
+        std::vector<Clipper2Lib::Point64> quads;
+        for (const Clipper2Lib::Path64& ringA : a) {
+            if (ringA.empty()) continue;
+            for (const Clipper2Lib::Path64& ringB : b) {
+                if (ringB.empty()) continue;
+                Geometry::MinkowskiQuads::append(ringA, ringB, true, quads);
+            }
+            Geometry::MinkowskiQuads::appendPaths(quads, out);
+            quads.clear();
+            Clipper2Lib::Paths64 copy = Clipper2Lib::TranslatePaths(b, ringA.front().x, ringA.front().y);
+            out.insert(out.end(), copy.begin(), copy.end());
+        }
+    }
+
+    // Every p = a + b either has a and b on the boundaries (the ring sweeps) or, following the
+    // component of a's region inside p - b, contains a whole ring of one shape, so p lies in the
+    // other shape placed at a vertex of that ring. All pieces are positive, so a NonZero union of
+    // the raw quads and copies is the set union.
+    Clipper2Lib::Paths64 minkowskiSumRegions(const Clipper2Lib::Paths64& a, const Clipper2Lib::Paths64& b) {
+        if (a.empty() || b.empty()) return Clipper2Lib::Paths64();
+        Clipper2Lib::Paths64 pieces;
+        appendBoundarySum(a, b, pieces);
+        for (const Clipper2Lib::Path64& ringB : b) {
+            if (ringB.empty()) continue;
+            Clipper2Lib::Paths64 copy = Clipper2Lib::TranslatePaths(a, ringB.front().x, ringB.front().y);
+            pieces.insert(pieces.end(), copy.begin(), copy.end());
+        }
+        return Clipper2Lib::Union(pieces, Clipper2Lib::FillRule::NonZero);
+    }
+
+    Clipper2Lib::Paths64 minkowskiInnerRegion(const Clipper2Lib::Paths64& container, const Clipper2Lib::Paths64& part) {
+        if (container.empty() || part.empty()) return Clipper2Lib::Paths64();
+        const Clipper2Lib::Paths64 reflected = reflectRegion(part);
+
+        // Placements where the part touches the outside of the container's material:
+        // the boundary terms of complement(container) (+) reflect(part).
+        Clipper2Lib::Paths64 band;
+        appendBoundarySum(container, reflected, band);
+
+        // The remaining term, complement(container) shifted by a vertex of each reflected ring,
+        // is excluded by intersecting the container shifted by those vertices.
+        Clipper2Lib::Paths64 allowed;
+        for (const Clipper2Lib::Path64& ring : reflected) {
+            if (ring.empty()) continue;
+            Clipper2Lib::Paths64 shifted = Clipper2Lib::TranslatePaths(container, ring.front().x, ring.front().y);
+            allowed = allowed.empty() ? Clipper2Lib::Union(shifted, Clipper2Lib::FillRule::NonZero)
+                                      : Clipper2Lib::Intersect(allowed, shifted, Clipper2Lib::FillRule::NonZero);
+            if (allowed.empty()) return allowed;
+        }
+        return Clipper2Lib::Difference(allowed, band, Clipper2Lib::FillRule::NonZero);
+    }
+
+    Clipper2Lib::Paths64 offsetRegion(const Clipper2Lib::Paths64& region, double delta, double miterLimit) {
+        if (region.empty() || delta == 0) return region;
+        Clipper2Lib::ClipperOffset offset(miterLimit);
+        offset.AddPaths(region, Clipper2Lib::JoinType::Miter, Clipper2Lib::EndType::Polygon);
+        Clipper2Lib::PolyTree64 tree;
+        offset.Execute(delta, tree);
+
+        const Clipper2Lib::PolyPath64* largest = nullptr;
+        double largestArea = 0;
+        for (const auto& piece : tree) {
+            const double pieceArea = std::abs(Clipper2Lib::Area(piece->Polygon()));
+            if (pieceArea > largestArea) {
+                largestArea = pieceArea;
+                largest = piece.get();
+            }
+        }
+        if (!largest) return Clipper2Lib::Paths64();
+        Clipper2Lib::Paths64 holes;
+        holes.reserve(largest->Count());
+        for (const auto& hole : *largest) holes.push_back(hole->Polygon());
+        return orientedRegion(largest->Polygon(), holes);
+    }
+
+    bool isAxisAlignedRectangle(const Clipper2Lib::Path64& path, Clipper2Lib::Rect64* bounds) {
+        if (path.size() < 4) return false;
+        const Clipper2Lib::Rect64 box = Clipper2Lib::GetBounds(path);
+        if (box.Width() <= 0 || box.Height() <= 0) return false;
+        for (const Clipper2Lib::Point64& p : path) {
+            if (p.x != box.left && p.x != box.right && p.y != box.top && p.y != box.bottom) return false;
+        }
+        // All vertices on the box, so anything short of its full area cuts a corner.
+        const double boxArea = static_cast<double>(box.Width()) * static_cast<double>(box.Height());
+        if (std::abs(std::abs(Clipper2Lib::Area(path)) - boxArea) > boxArea * 1e-12) return false;
+        if (bounds) *bounds = box;
+        return true;
+    }
+
+    Clipper2Lib::Paths64 rectangleInnerRegion(const Clipper2Lib::Rect64& container, const Clipper2Lib::Paths64& holes,
+                                              const Clipper2Lib::Paths64& part) {
+        if (part.empty()) return Clipper2Lib::Paths64();
+        // The part's outer ring bounds it, its holes do not matter against a convex container.
+        const Clipper2Lib::Rect64 partBounds = Clipper2Lib::GetBounds(part);
+        const Clipper2Lib::Rect64 allowed(container.left - partBounds.left, container.top - partBounds.top,
+                                          container.right - partBounds.right, container.bottom - partBounds.bottom);
+        if (allowed.right < allowed.left || allowed.bottom < allowed.top) return Clipper2Lib::Paths64();
+
+        Clipper2Lib::Paths64 region = orientedRegion(allowed.AsPath(), Clipper2Lib::Paths64());
+        if (holes.empty()) return region;
+        // A part as large as the container in both directions covers every hole.
+        if (allowed.Width() == 0 && allowed.Height() == 0) return Clipper2Lib::Paths64();
+
+        Clipper2Lib::Rect64 partRect;
+        const bool rectangularPart = part.size() == 1 && isAxisAlignedRectangle(part.front(), &partRect);
+        const Clipper2Lib::Paths64 reflected = reflectRegion(part);
+        Clipper2Lib::Paths64 forbidden;
+        for (const Clipper2Lib::Path64& hole : holes) {
+            Clipper2Lib::Rect64 holeRect;
+            if (rectangularPart && isAxisAlignedRectangle(hole, &holeRect)) {
+                const Clipper2Lib::Rect64 overlap(holeRect.left - partRect.right, holeRect.top - partRect.bottom,
+                                                  holeRect.right - partRect.left, holeRect.bottom - partRect.top);
+                forbidden.push_back(orientedRegion(overlap.AsPath(), Clipper2Lib::Paths64()).front());
+            } else {
+                const Clipper2Lib::Paths64 sum = minkowskiSumRegions(orientedRegion(hole, Clipper2Lib::Paths64()), reflected);
+                forbidden.insert(forbidden.end(), sum.begin(), sum.end());
+            }
+        }
+        if (allowed.Width() == 0 || allowed.Height() == 0) {
+            // An exact fit in one direction leaves a segment of positions: cut the forbidden zones
+            // out of it as an open path, the pieces are two-point regions.
+            Clipper2Lib::Clipper64 clipper;
+            clipper.AddOpenSubject(Clipper2Lib::Paths64{Clipper2Lib::Path64{Clipper2Lib::Point64(allowed.left, allowed.top),
+                                                                            Clipper2Lib::Point64(allowed.right, allowed.bottom)}});
+            clipper.AddClip(forbidden);
+            Clipper2Lib::Paths64 closed, open;
+            clipper.Execute(Clipper2Lib::ClipType::Difference, Clipper2Lib::FillRule::NonZero, closed, open);
+            return open;
+        }
+        // Only the parts of the forbidden zones on the shrunk rectangle matter for the difference.
+        forbidden = Clipper2Lib::RectClip(allowed, forbidden);
+        if (forbidden.empty()) return region;
+        return Clipper2Lib::Difference(region, forbidden, Clipper2Lib::FillRule::NonZero);
+    }
+
 } // namespace GeometryUtils
@@ -4,6 +4,8 @@
 #include <QPointF>
 #include <QPolygonF>
 #include <QRectF>
+#include <QList>
+#include "Clipper2/clipper.h" // For Clipper2Lib::Path64 (fixed-point geometry)
 
 namespace GeometryUtils {
     // Placeholder for various geometric utility functions
@@ -15,6 +17,84 @@ double area(const QPolygonF& polygon);
 QRectF boundingBox(const QPolygonF& polygon);
 
 bool isPointInPolygon(const QPointF& point, const QPolygonF& polygon, Qt::FillRule fillRule = Qt::OddEvenFill );
+
+// Canonical 64-bit fingerprint of a shape, used as its NFP identity.
+// Coordinates are snapped to a grid of 'quantum' units, so float noise below that does not
+// change it; rings are read from their smallest vertex, so it does not depend on the start
+// vertex either, and holes are hashed as an unordered set. The result is never 0.
+// Position and orientation are part of the identity (NFPs are relative to the part origin).
+quint64 geometryFingerprint(const QPolygonF& outer, const QList<QPolygonF>& holes, double quantum = 1e-4);
+
+// --- Fixed-point geometry ---
+// Parts, sheets and NFPs are handled as Clipper2 Path64 at Configuration::clipperScale
+// (integer unit = 1/scale of a document unit). These convert at the boundaries.
+Clipper2Lib::Point64 toPoint64(const QPointF& point, double scale);
+Clipper2Lib::Path64 toPath64(const QPolygonF& polygon, double scale);
+Clipper2Lib::Paths64 toPaths64(const QList<QPolygonF>& polygons, double scale);
+QPointF fromPoint64(const Clipper2Lib::Point64& point, double scale);
+QPolygonF fromPath64(const Clipper2Lib::Path64& path, double scale);
+QList<QPolygonF> fromPaths64(const Clipper2Lib::Paths64& paths, double scale);
+
+// cos/sin of a rotation in degrees, exact (0 and +-1) for quarter turns.
+void rotationFactors(double degrees, double& cosA, double& sinA);
+// Rotates about the origin with the QTransform::rotate convention, rounding to the integer grid.
+// Quarter turns are exact.
+Clipper2Lib::Point64 rotatePoint64(const Clipper2Lib::Point64& point, double cosA, double sinA);
+Clipper2Lib::Path64 rotatePath64(const Clipper2Lib::Path64& path, double degrees);
+
+// --- Convex shapes ---
+// True if the polygon is convex: its area matches the area of its convex hull (Geometry::HullPolygon)
+// within 'relativeTolerance'. Collinear vertices are allowed; self-intersecting rings are not convex.
+bool isConvex(const QPolygonF& polygon, double relativeTolerance = 1e-9);
+
+// Minkowski sum of two convex paths by merging their edge sequences in angular order, O(n+m).
+// Either orientation is accepted; the result is counter-clockwise (positive Clipper2 area).
+// Duplicate, collinear and rounding-induced reflex vertices are dropped first, so paths that
+// are convex up to integer rounding (e.g. after rotatePath64) are fine.
+// Returns an empty path if either input is degenerate (fewer than 3 vertices after cleanup).
+Clipper2Lib::Path64 minkowskiSumConvex(const Clipper2Lib::Path64& a, const Clipper2Lib::Path64& b);
+
+// Splits a simple polygon into convex pieces: ear-clipping triangulation, then Hertel-Mehlhorn
+// merging of triangles across diagonals while the result stays convex (at most four times the
+// optimal piece count). Pieces are counter-clockwise. A convex input is returned as its only piece.
+// Returns an empty list if no ear can be found (self-intersecting input).
+Clipper2Lib::Paths64 convexDecomposition(const Clipper2Lib::Path64& path);
+
+// --- Regions with holes ---
+// A region is a list of rings: outer boundaries counter-clockwise (positive Clipper2 area), holes
+// clockwise, so a NonZero fill gives its material. This builds one from an outer path and its holes,
+// whatever their input winding.
+Clipper2Lib::Paths64 orientedRegion(const Clipper2Lib::Path64& outer, const Clipper2Lib::Paths64& holes);
+
+// Minkowski sum of two regions, holes included. Clipper2's MinkowskiSum only sweeps one path along
+// another, which leaves the interior open and knows nothing about holes; here the edge-pair quads of
+// every ring pair (Geometry::MinkowskiQuads) and one copy of each region placed at a vertex of every
+// ring of the other go through a single union, which covers every point of the sum. Holes survive where one shape fits inside a hole of the other.
+Clipper2Lib::Paths64 minkowskiSumRegions(const Clipper2Lib::Paths64& a, const Clipper2Lib::Paths64& b);
+
+// Translations p for which 'part' + p lies inside 'container', touching allowed (container (-) part).
+// This is the complement of complement(container) (+) reflect(part), evaluated without the unbounded
+// complement: the container shifted by a vertex of each reflected part ring, minus the band swept by
+// the reflected part along the container's rings. Container holes become holes of the result.
+Clipper2Lib::Paths64 minkowskiInnerRegion(const Clipper2Lib::Paths64& container, const Clipper2Lib::Paths64& part);
+
+// Offsets a region by 'delta' fixed-point units with mitered joins (ClipperOffset): for delta > 0
+// outer boundaries grow and holes shrink, for delta < 0 the reverse. Spikes sharper than
+// 'miterLimit' times delta are squared off. Holes that close up are dropped; if the offset splits
+// the region, only its largest piece (with its holes) is kept. Empty if nothing is left.
+Clipper2Lib::Paths64 offsetRegion(const Clipper2Lib::Paths64& region, double delta, double miterLimit = 4.0);
+
+// --- Axis-aligned rectangles ---
+// True if 'path' is an axis-aligned rectangle: every vertex lies on its bounding box and the areas
+// match (collinear vertices along the edges are allowed). Stores the box in 'bounds' when given.
+bool isAxisAlignedRectangle(const Clipper2Lib::Path64& path, Clipper2Lib::Rect64* bounds = nullptr);
+
+// minkowskiInnerRegion for a rectangular container, as the JS getInnerNfp special case: the rectangle
+// shrunk by the part's bounds, in O(n). Each container hole removes hole (+) reflect(part), which is
+// itself a rectangle when hole and part are, clipped to the shrunk rectangle with RectClip first.
+// Empty if the part is wider or taller than the container; an exact fit gives a degenerate rectangle.
+Clipper2Lib::Paths64 rectangleInnerRegion(const Clipper2Lib::Rect64& container, const Clipper2Lib::Paths64& holes,
+                                          const Clipper2Lib::Paths64& part);
 }
 
 #endif // GEOMETRYUTILS_H
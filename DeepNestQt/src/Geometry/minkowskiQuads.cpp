@@ -0,0 +1,195 @@
+#include "minkowskiQuads.h"
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#define MINKOWSKI_QUADS_AVX2
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+#include <arm_neon.h>
+#define MINKOWSKI_QUADS_NEON
+#endif
+
+namespace Geometry {
+
+namespace {
+
+using Clipper2Lib::Point64;
+typedef MinkowskiQuads::Point32 Point32;
+
+// The vector kernels load points as packed coordinate pairs.
+static_assert(sizeof(Point64) == 2 * sizeof(int64_t), "Point64 must be two packed int64 coordinates");
+static_assert(sizeof(Point32) == 2 * sizeof(int32_t), "Point32 must be two packed int32 coordinates");
+
+inline Point64 sum(const Point64& a, const Point64& b) { return Point64(a.x + b.x, a.y + b.y); }
+inline Point32 sum(const Point32& a, const Point32& b) { return Point32{a.x + b.x, a.y + b.y}; }
+
+// Writes p0+q0, p1+q0, p1+q1, p0+q1, or the reverse order after the first point when the
+// edges turn clockwise.
+template <typename P>
+inline void writeQuad(P* out, const P& p0, const P& p1, const P& q0, const P& q1, bool positive) {
+    out[0] = sum(p0, q0);
+    out[2] = sum(p1, q1);
+    out[positive ? 1 : 3] = sum(p1, q0);
+    out[positive ? 3 : 1] = sum(p0, q1);
+}
+
+// One edge (p0, p1) of the first sequence against consecutive vertices q0, q1 = q0 + 1 of the second.
+#if defined(MINKOWSKI_QUADS_AVX2)
+struct RowKernel64 {
+    __m256i p0, p1;
+    RowKernel64(const Point64& a0, const Point64& a1)
+        : p0(_mm256_broadcastsi128_si256(_mm_loadu_si128(reinterpret_cast<const __m128i*>(&a0)))),
+          p1(_mm256_broadcastsi128_si256(_mm_loadu_si128(reinterpret_cast<const __m128i*>(&a1)))) {}
+    void write(Point64* out, const Point64* q, bool positive) const {
+        const __m256i qq = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(q)); // q0 | q1
+        const __m256i s0 = _mm256_add_epi64(qq, p0);                                 // p0+q0 | p0+q1
+        const __m256i s1 = _mm256_add_epi64(qq, p1);                                 // p1+q0 | p1+q1
+        __m256i* dst = reinterpret_cast<__m256i*>(out);
+        if (positive) {
+            _mm256_storeu_si256(dst, _mm256_permute2x128_si256(s0, s1, 0x20));     // p0+q0 | p1+q0
+            _mm256_storeu_si256(dst + 1, _mm256_permute2x128_si256(s1, s0, 0x31)); // p1+q1 | p0+q1
+        } else {
+            _mm256_storeu_si256(dst, s0);
+            _mm256_storeu_si256(dst + 1, _mm256_permute2x128_si256(s1, s1, 0x01)); // p1+q1 | p1+q0
+        }
+    }
+};
+
+struct RowKernel32 {
+    __m128i p0, p1;
+    RowKernel32(const Point32& a0, const Point32& a1)
+        : p0(_mm_unpacklo_epi64(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(&a0)),
+                                _mm_loadl_epi64(reinterpret_cast<const __m128i*>(&a0)))),
+          p1(_mm_unpacklo_epi64(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(&a1)),
+                                _mm_loadl_epi64(reinterpret_cast<const __m128i*>(&a1)))) {}
+    void write(Point32* out, const Point32* q, bool positive) const {
+        const __m128i qq = _mm_loadu_si128(reinterpret_cast<const __m128i*>(q)); // q0 | q1
+        const __m128i s0 = _mm_add_epi32(qq, p0);
+        const __m128i s1 = _mm_add_epi32(qq, p1);
+        __m128i* dst = reinterpret_cast<__m128i*>(out);
+        if (positive) {
+            _mm_storeu_si128(dst, _mm_unpacklo_epi64(s0, s1));
+            _mm_storeu_si128(dst + 1, _mm_unpackhi_epi64(s1, s0));
+        } else {
+            _mm_storeu_si128(dst, s0);
+            _mm_storeu_si128(dst + 1, _mm_shuffle_epi32(s1, _MM_SHUFFLE(1, 0, 3, 2)));
+        }
+    }
+};
+#elif defined(MINKOWSKI_QUADS_NEON)
+struct RowKernel64 {
+    int64x2_t p0, p1;
+    RowKernel64(const Point64& a0, const Point64& a1)
+        : p0(vld1q_s64(reinterpret_cast<const int64_t*>(&a0))), p1(vld1q_s64(reinterpret_cast<const int64_t*>(&a1))) {}
+    void write(Point64* out, const Point64* q, bool positive) const {
+        const int64x2_t q0 = vld1q_s64(reinterpret_cast<const int64_t*>(q));
+        const int64x2_t q1 = vld1q_s64(reinterpret_cast<const int64_t*>(q + 1));
+        int64_t* dst = reinterpret_cast<int64_t*>(out);
+        vst1q_s64(dst, vaddq_s64(p0, q0));
+        vst1q_s64(dst + 4, vaddq_s64(p1, q1));
+        vst1q_s64(dst + (positive ? 2 : 6), vaddq_s64(p1, q0));
+        vst1q_s64(dst + (positive ? 6 : 2), vaddq_s64(p0, q1));
+    }
+};
+
+struct RowKernel32 {
+    int32x4_t p0, p1;
+    RowKernel32(const Point32& a0, const Point32& a1)
+        : p0(vcombine_s32(vld1_s32(&a0.x), vld1_s32(&a0.x))), p1(vcombine_s32(vld1_s32(&a1.x), vld1_s32(&a1.x))) {}
+    void write(Point32* out, const Point32* q, bool positive) const {
+        const int32x4_t qq = vld1q_s32(&q->x);   // q0 | q1
+        const int32x4_t s0 = vaddq_s32(qq, p0);  // p0+q0 | p0+q1
+        const int32x4_t s1 = vaddq_s32(qq, p1);  // p1+q0 | p1+q1
+        int32_t* dst = &out->x;
+        vst1_s32(dst, vget_low_s32(s0));
+        vst1_s32(dst + 4, vget_high_s32(s1));
+        vst1_s32(dst + (positive ? 2 : 6), vget_low_s32(s1));
+        vst1_s32(dst + (positive ? 6 : 2), vget_high_s32(s0));
+    }
+};
+#else
+template <typename P>
+struct RowKernel {
+    P p0, p1;
+    RowKernel(const P& a0, const P& a1) : p0(a0), p1(a1) {}
+    void write(P* out, const P* q, bool positive) const { writeQuad(out, p0, p1, q[0], q[1], positive); }
+};
+typedef RowKernel<Point64> RowKernel64;
+typedef RowKernel<Point32> RowKernel32;
+#endif
+
+template <typename P> struct KernelFor;
+template <> struct KernelFor<Point64> { typedef RowKernel64 type; };
+template <> struct KernelFor<Point32> { typedef RowKernel32 type; };
+
+template <typename P>
+void convolve(const P* a, std::size_t aCount, const P* b, std::size_t bCount, bool closed, std::vector<P>& quads) {
+    if (aCount < 2 || bCount < 2) return;
+    const std::size_t aEdges = closed ? aCount : aCount - 1;
+    const std::size_t bEdges = closed ? bCount : bCount - 1;
+
+    // Edge vectors of 'b' for the orientation test, in double: int64 cross products can overflow.
+    std::vector<double> bdx(bEdges), bdy(bEdges);
+    for (std::size_t j = 0; j < bEdges; ++j) {
+        const P& q1 = b[j + 1 == bCount ? 0 : j + 1];
+        bdx[j] = static_cast<double>(q1.x) - static_cast<double>(b[j].x);
+        bdy[j] = static_cast<double>(q1.y) - static_cast<double>(b[j].y);
+    }
+
+    const std::size_t start = quads.size();
+    quads.resize(start + aEdges * bEdges * 4);
+    P* out = quads.data() + start;
+    // The wrapping edge of a closed 'b' has no contiguous vertex pair, it is written separately.
+    const std::size_t contiguousEdges = bCount - 1;
+    for (std::size_t i = 0; i < aEdges; ++i) {
+        const P& p0 = a[i];
+        const P& p1 = a[i + 1 == aCount ? 0 : i + 1];
+        const double adx = static_cast<double>(p1.x) - static_cast<double>(p0.x);
+        const double ady = static_cast<double>(p1.y) - static_cast<double>(p0.y);
+        const typename KernelFor<P>::type row(p0, p1);
+        for (std::size_t j = 0; j < contiguousEdges; ++j) {
+            const double cross = adx * bdy[j] - ady * bdx[j];
+            if (cross == 0) continue; // Parallel edges sweep no area
+            row.write(out, b + j, cross > 0);
+            out += 4;
+        }
+        if (closed) {
+            const double cross = adx * bdy[bEdges - 1] - ady * bdx[bEdges - 1];
+            if (cross != 0) {
+                writeQuad(out, p0, p1, b[bCount - 1], b[0], cross > 0);
+                out += 4;
+            }
+        }
+    }
+    quads.resize(static_cast<std::size_t>(out - quads.data()));
+}
+
+} // namespace
+
+void MinkowskiQuads::append(const Clipper2Lib::Path64& a, const Clipper2Lib::Path64& b, bool closed,
+                            std::vector<Clipper2Lib::Point64>& quads) {
+    convolve(a.data(), a.size(), b.data(), b.size(), closed, quads);
+}
+
+void MinkowskiQuads::append(const Point32* a, std::size_t aCount, const Point32* b, std::size_t bCount,
+                            std::vector<Point32>& quads) {
+    convolve(a, aCount, b, bCount, false, quads);
+}
+
+void MinkowskiQuads::appendPaths(const std::vector<Clipper2Lib::Point64>& quads, Clipper2Lib::Paths64& paths) {
+    paths.reserve(paths.size() + quads.size() / 4);
+    for (std::size_t k = 0; k + 4 <= quads.size(); k += 4) {
+        paths.emplace_back(quads.begin() + static_cast<std::ptrdiff_t>(k), quads.begin() + static_cast<std::ptrdiff_t>(k + 4));
+    }
+}
+
+const char* MinkowskiQuads::kernelName() {
+#if defined(MINKOWSKI_QUADS_AVX2)
+    return "avx2";
+#elif defined(MINKOWSKI_QUADS_NEON)
+    return "neon";
+#else
+    return "scalar";
+#endif
+}
+
+} // namespace Geometry
@@ -0,0 +1,41 @@
+#ifndef MINKOWSKIQUADS_H
+#define MINKOWSKIQUADS_H
+
+#include "Clipper2/clipper.h" // For Clipper2Lib::Path64
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace Geometry {
+
+// Edge-pair quads of a Minkowski convolution: for every edge (p0, p1) of one sequence and
+// (q0, q1) of the other, the parallelogram p0+q0, p1+q0, p1+q1, p0+q1. Their union (with the
+// shapes placed at one vertex of each other's rings) is the Minkowski sum; this is the inner
+// loop of Clipper2's MinkowskiSum and of the original module's convolve_two_point_sequences.
+// All quads go to one contiguous buffer, four points each, counter-clockwise (positive area);
+// pairs of parallel edges give empty quads and are skipped. The point sums are vectorized with
+// AVX2 (when compiled with -mavx2, see DeepNestQt.pro) or NEON, otherwise plain C++.
+class MinkowskiQuads {
+public:
+    // Boost.Polygon's point_data<int> layout, for the original module.
+    struct Point32 {
+        int32_t x;
+        int32_t y;
+    };
+
+    // Quads of sequences 'a' and 'b'; 'closed' adds the edges from the last vertex back to the first.
+    static void append(const Clipper2Lib::Path64& a, const Clipper2Lib::Path64& b, bool closed,
+                       std::vector<Clipper2Lib::Point64>& quads);
+    // Same for open int sequences (closed rings repeat their first vertex at the end).
+    static void append(const Point32* a, std::size_t aCount, const Point32* b, std::size_t bCount,
+                       std::vector<Point32>& quads);
+
+    // Appends every quad of the buffer as a path, so one Clipper2 union processes all of them.
+    static void appendPaths(const std::vector<Clipper2Lib::Point64>& quads, Clipper2Lib::Paths64& paths);
+
+    // Kernel the point sums were compiled for: "avx2", "neon" or "scalar".
+    static const char* kernelName();
+};
+
+} // namespace Geometry
+#endif // MINKOWSKIQUADS_H
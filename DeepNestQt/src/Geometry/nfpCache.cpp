@@ -1,71 +1,359 @@
 #include "nfpCache.h"
-#include <QStringBuilder> // For efficient string concatenation
-#include <algorithm>    // For std::min/max if canonicalizing key order
+#include "geometryUtils.h" // For GeometryUtils::rotatePoint64
+#include <QReadLocker>
+#include <QWriteLocker>
+#include <QThread>
+#include <algorithm>
+#include <cmath>
 
 namespace Geometry {
 
-NfpCache::NfpCache() {
-    // Constructor
+// --- NfpKey ---
+
+quint64 NfpKey::hash() const {
+    // Pack the key into two words and run them through a splitmix64 finalizer.
+    quint64 h = (static_cast<quint64>(partA) << 32) | partB;
+    h ^= ((static_cast<quint64>(rotationA) << 24) | (static_cast<quint64>(rotationB) << 8) | flags) * 0x9E3779B97F4A7C15ULL;
+    h ^= h >> 30;
+    h *= 0xBF58476D1CE4E5B9ULL;
+    h ^= h >> 27;
+    h *= 0x94D049BB133111EBULL;
+    h ^= h >> 31;
+    return h;
+}
+
+quint16 NfpKey::quantizeRotation(double degrees) {
+    double normalized = std::fmod(degrees, 360.0);
+    if (normalized < 0) normalized += 360.0;
+    int steps = static_cast<int>(std::lround(normalized * 100.0));
+    if (steps >= 36000) steps -= 36000; // 359.999 rounds up to a full turn
+    return static_cast<quint16>(steps);
+}
+
+uint qHash(const NfpKey& key, uint seed) {
+    quint64 h = key.hash();
+    return static_cast<uint>(h ^ (h >> 32)) ^ seed;
+}
+
+// --- NfpView ---
+
+NfpView::NfpView(const NfpHandle& handle, const Clipper2Lib::Point64& translation, double rotationDegrees)
+    : nfp(handle), offset(translation), rotation(rotationDegrees) {
+    GeometryUtils::rotationFactors(rotationDegrees, cos_, sin_);
+}
+
+Clipper2Lib::Point64 NfpView::toLocal(const Clipper2Lib::Point64& point) const {
+    const Clipper2Lib::Point64 delta(point.x - offset.x, point.y - offset.y);
+    if (cos_ == 1.0) return delta;
+    return GeometryUtils::rotatePoint64(delta, cos_, -sin_); // Inverse rotation
+}
+
+Clipper2Lib::Path64 NfpView::path(size_t index) const {
+    const Clipper2Lib::Path64& source = nfp->paths.at(index);
+    Clipper2Lib::Path64 result;
+    result.reserve(source.size());
+    // Same convention as QTransform::rotate (and NestingEngine::transformPart).
+    for (const Clipper2Lib::Point64& p : source) {
+        const Clipper2Lib::Point64 rotated = GeometryUtils::rotatePoint64(p, cos_, sin_);
+        result.push_back(Clipper2Lib::Point64(rotated.x + offset.x, rotated.y + offset.y));
+    }
+    return result;
+}
+
+// --- NfpTable ---
+
+NfpTable::NfpTable(int initialCapacity) : size_(0), bytes_(0), clockHand_(0) {
+    int capacity = 16;
+    while (capacity < initialCapacity) capacity <<= 1;
+    slots_.resize(capacity);
+}
+
+int NfpTable::probe(const NfpKey& key) const {
+    const int mask = slots_.size() - 1;
+    int index = static_cast<int>(key.hash() & static_cast<quint64>(mask));
+    while (slots_[index].occupied && slots_[index].key != key) {
+        index = (index + 1) & mask;
+    }
+    return index;
+}
+
+const NfpHandle* NfpTable::peek(const NfpKey& key) const {
+    const Slot& slot = slots_[probe(key)];
+    return slot.occupied ? &slot.value : nullptr;
+}
+
+const NfpHandle* NfpTable::find(const NfpKey& key) const {
+    const Slot& slot = slots_[probe(key)];
+    if (!slot.occupied) return nullptr;
+    const int weight = usageWeight(key);
+    if (slot.usage.loadRelaxed() < weight) {
+        slot.usage.storeRelaxed(weight); // Benign race: concurrent readers all store the same weight
+    }
+    return &slot.value;
+}
+
+void NfpTable::insert(const NfpKey& key, const NfpHandle& value, qint64 cost) {
+    // Keep the load factor below 0.7 so probe runs stay short.
+    if ((size_ + 1) * 10 > slots_.size() * 7) {
+        grow();
+    }
+    Slot& slot = slots_[probe(key)];
+    if (!slot.occupied) {
+        slot.occupied = true;
+        slot.key = key;
+        ++size_;
+    } else {
+        bytes_ -= slot.cost;
+    }
+    slot.value = value;
+    slot.cost = cost;
+    slot.usage.storeRelaxed(usageWeight(key));
+    bytes_ += cost;
+}
+
+qint64 NfpTable::evictOne() {
+    if (size_ == 0) return 0;
+    const int mask = slots_.size() - 1;
+    for (;;) {
+        const int index = clockHand_;
+        clockHand_ = (clockHand_ + 1) & mask;
+        Slot& slot = slots_[index];
+        if (!slot.occupied) continue;
+        const int usage = slot.usage.loadRelaxed();
+        if (usage > 0) {
+            slot.usage.storeRelaxed(usage - 1); // Second chance
+            continue;
+        }
+        const qint64 freed = slot.cost;
+        removeAt(index);
+        return freed;
+    }
+}
+
+// Backward-shift deletion: later entries of the same probe run are moved into the hole,
+// so lookups never need tombstones.
+void NfpTable::removeAt(int index) {
+    const int mask = slots_.size() - 1;
+    bytes_ -= slots_[index].cost;
+    --size_;
+    int hole = index;
+    int next = (hole + 1) & mask;
+    while (slots_[next].occupied) {
+        const int home = static_cast<int>(slots_[next].key.hash() & static_cast<quint64>(mask));
+        // The entry may only move back if its home slot is not cyclically within (hole, next].
+        const bool homeInRange = (hole <= next) ? (home > hole && home <= next)
+                                                : (home > hole || home <= next);
+        if (!homeInRange) {
+            slots_[hole] = slots_[next];
+            hole = next;
+        }
+        next = (next + 1) & mask;
+    }
+    slots_[hole] = Slot();
+}
+
+void NfpTable::grow() {
+    QVector<Slot> oldSlots;
+    oldSlots.swap(slots_);
+    slots_.resize(oldSlots.size() * 2);
+    for (Slot& old : oldSlots) {
+        if (!old.occupied) continue;
+        Slot& slot = slots_[probe(old.key)];
+        slot.occupied = true;
+        slot.key = old.key;
+        slot.value = std::move(old.value);
+        slot.cost = old.cost;
+        slot.usage.storeRelaxed(old.usage.loadRelaxed());
+    }
+    clockHand_ = 0;
+}
+
+void NfpTable::clear() {
+    const int capacity = slots_.size();
+    slots_.clear();
+    slots_.resize(capacity);
+    size_ = 0;
+    bytes_ = 0;
+    clockHand_ = 0;
+}
+
+// --- NfpCache ---
+
+NfpCache::NfpCache(int shardCount, qint64 memoryBudget) {
+    if (shardCount <= 0) {
+        shardCount = 4 * QThread::idealThreadCount();
+    }
+    int shards = 1;
+    while (shards < shardCount && shards < 1024) shards <<= 1;
+    shards_.reset(new Shard[shards]);
+    shardMask_ = shards - 1;
+    shardBudget_ = memoryBudget > 0 ? std::max<qint64>(1, memoryBudget / shards) : 0;
 }
 
 NfpCache::~NfpCache() {
     // Destructor
 }
 
-bool NfpCache::findNfp(const QString& key, CachedNfp& result) const {
-    QMutexLocker locker(&mutex_);
-    if (cache_.contains(key)) {
-        result = cache_.value(key);
-        return result.isValid; // Only return true if the cached NFP is marked valid
+NfpHandle NfpCache::findNfp(const NfpKey& key) const {
+    const NfpKind kind = (key.flags & NfpKey::Inside) ? NfpKind::Inner : NfpKind::Outer;
+    Shard& shard = shardFor(key);
+    QReadLocker locker(&shard.lock);
+    const NfpHandle* cached = shard.table.find(key);
+    if (cached && (*cached)->isValid) { // Only hand out entries marked valid
+        stats_.recordHit(kind);
+        return *cached;
     }
-    return false;
+    stats_.recordMiss(kind);
+    return NfpHandle();
+}
+
+bool NfpCache::contains(const NfpKey& key) const {
+    Shard& shard = shardFor(key);
+    QReadLocker locker(&shard.lock);
+    const NfpHandle* cached = shard.table.peek(key);
+    return cached && (*cached)->isValid;
 }
 
-void NfpCache::storeNfp(const QString& key, const CachedNfp& nfp) {
-    QMutexLocker locker(&mutex_);
-    // Ensure we are storing a valid NFP, or a placeholder indicating a calculation attempt.
-    // The CachedNfp struct has an 'isValid' flag.
-    cache_.insert(key, nfp);
+NfpHandle NfpCache::storeNfp(const NfpKey& key, const CachedNfp& nfp) {
+    // Build the shared entry before taking the lock, the write section is just the table insert.
+    NfpHandle handle(new CachedNfp(nfp));
+    const qint64 cost = entryCost(nfp);
+    Shard& shard = shardFor(key);
+    QWriteLocker locker(&shard.lock);
+    insertLocked(shard, key, handle, cost);
+    return handle;
+}
+
+void NfpCache::insertLocked(Shard& shard, const NfpKey& key, const NfpHandle& handle, qint64 cost) {
+    shard.table.insert(key, handle, cost);
+    if (shardBudget_ > 0) {
+        // An entry larger than the whole shard budget is still kept on its own.
+        while (shard.table.bytes() > shardBudget_ && shard.table.size() > 1) {
+            stats_.recordEviction(shard.table.evictOne());
+        }
+    }
+}
+
+NfpHandle NfpCache::getOrCompute(const NfpKey& key, const std::function<CachedNfp()>& compute) {
+    NfpHandle cached = findNfp(key);
+    if (!cached.isNull()) {
+        return cached;
+    }
+
+    Shard& shard = shardFor(key);
+    QSharedPointer<PendingNfp> pending;
+    bool computing = false;
+    {
+        QWriteLocker locker(&shard.lock);
+        // Another thread may have stored the entry since the read-locked lookup.
+        const NfpHandle* stored = shard.table.find(key);
+        if (stored && (*stored)->isValid) {
+            return *stored;
+        }
+        pending = shard.inFlight.value(key);
+        if (pending.isNull()) {
+            pending.reset(new PendingNfp);
+            shard.inFlight.insert(key, pending);
+            computing = true;
+        }
+    }
+
+    if (!computing) {
+        stats_.recordWait((key.flags & NfpKey::Inside) ? NfpKind::Inner : NfpKind::Outer);
+        QMutexLocker waitLocker(&pending->mutex);
+        while (!pending->done) {
+            pending->finished.wait(&pending->mutex);
+        }
+        return pending->result;
+    }
+
+    NfpHandle handle;
+    try {
+        handle.reset(new CachedNfp(compute()));
+    } catch (...) {
+        finishPending(shard, key, pending, NfpHandle());
+        throw;
+    }
+    finishPending(shard, key, pending, handle);
+    return handle;
+}
+
+void NfpCache::finishPending(Shard& shard, const NfpKey& key, const QSharedPointer<PendingNfp>& pending,
+                             const NfpHandle& result) {
+    {
+        // Store and retire under one lock, so a lookup sees either the computation or the entry.
+        QWriteLocker locker(&shard.lock);
+        if (!result.isNull()) {
+            insertLocked(shard, key, result, entryCost(*result));
+        }
+        shard.inFlight.remove(key);
+    }
+    QMutexLocker waitLocker(&pending->mutex);
+    pending->result = result;
+    pending->done = true;
+    pending->finished.wakeAll();
+}
+
+QJsonObject NfpCache::statisticsJson() const {
+    QJsonObject json = stats_.toJson();
+    json["entries"] = size();
+    json["bytes"] = static_cast<double>(memoryUsage());
+    json["budgetBytes"] = static_cast<double>(shardBudget_ * shardCount());
+    json["shards"] = shardCount();
+    return json;
+}
+
+qint64 NfpCache::entryCost(const CachedNfp& nfp) {
+    qint64 vertices = 0;
+    for (const Clipper2Lib::Path64& path : nfp.paths) {
+        vertices += static_cast<qint64>(path.size());
+    }
+    return static_cast<qint64>(sizeof(CachedNfp)) +
+           static_cast<qint64>(nfp.paths.size() * sizeof(Clipper2Lib::Path64)) +
+           vertices * static_cast<qint64>(sizeof(Clipper2Lib::Point64));
 }
 
 // Generates a cache key.
-// partAIsStatic: true if partA is the static part and partB is orbiting (e.g. NFP for placing B around A).
-// This parameter helps distinguish NFP(A,B) from NFP(B,A) contextually.
-// Rotations are converted to int after multiplying by a factor to handle precision issues with doubles in keys.
-// Flipped states are boolean.
-QString NfpCache::generateKey(const QString& partAId, double rotationA, bool flippedA,
-                              const QString& partBId, double rotationB, bool flippedB,
-                              bool partAIsStatic) { // True if A is static, B orbits. False if B is static, A orbits.
-    // Normalize rotation values to handle potential floating point inaccuracies if they represent degrees.
-    // E.g., multiply by 100 and convert to int to capture up to 2 decimal places of precision.
-    // Or, ensure rotations are always passed with a fixed, limited precision.
-    // For simplicity, we'll assume rotations are passed as discrete, comparable values (e.g., 0, 90, 180.123).
-    // A common practice is to use integer representation of angles (e.g. degrees * 1000).
-    
-    // Using QString::number with sufficient precision for doubles, or a custom formatting.
-    // Using 'g' format with enough precision, or 'f' with fixed.
-    QString rotAStr = QString::number(rotationA, 'f', 4);
-    QString rotBStr = QString::number(rotationB, 'f', 4);
-
-    // The order of A and B in the key should be consistent if NFP(A,B) vs NFP(B,A) might be looked up.
-    // If partAIsStatic distinguishes this, then direct concatenation is fine.
-    // If NFP(A,B) should be the same cache entry as NFP(B,A) under some conditions (e.g. they are symmetric),
-    // then part IDs could be sorted. However, typically the "static" part defines the context.
-    
-    QString keyString = partAId % "_" % rotAStr % "_" % (flippedA ? "t" : "f") % "vs" %
-                        partBId % "_" % rotBStr % "_" % (flippedB ? "t" : "f") %
-                        (partAIsStatic ? "_Astatic" : "_Bstatic");
-    return keyString;
+// The key order is significant: A is the orbiting (or fitting) part, B the static one.
+// Flip states and the inside/outside context are folded into the flag byte.
+NfpKey NfpCache::generateKey(int partAIndex, double rotationA, bool flippedA,
+                             int partBIndex, double rotationB, bool flippedB,
+                             bool inside) {
+    Q_ASSERT(partAIndex >= 0 && partBIndex >= 0); // Parts must be interned before key generation
+    NfpKey key;
+    key.partA = static_cast<quint32>(partAIndex);
+    key.partB = static_cast<quint32>(partBIndex);
+    key.rotationA = NfpKey::quantizeRotation(rotationA);
+    key.rotationB = NfpKey::quantizeRotation(rotationB);
+    key.flags = (flippedA ? NfpKey::FlippedA : 0) |
+                (flippedB ? NfpKey::FlippedB : 0) |
+                (inside ? NfpKey::Inside : 0);
+    return key;
 }
 
 void NfpCache::clear() {
-    QMutexLocker locker(&mutex_);
-    cache_.clear();
+    for (int i = 0; i <= shardMask_; ++i) {
+        QWriteLocker locker(&shards_[i].lock);
+        shards_[i].table.clear();
+    }
 }
 
 int NfpCache::size() const {
-    QMutexLocker locker(&mutex_); // For thread-safe size reading
-    return cache_.size();
+    int total = 0;
+    for (int i = 0; i <= shardMask_; ++i) {
+        QReadLocker locker(&shards_[i].lock); // For thread-safe size reading
+        total += shards_[i].table.size();
+    }
+    return total;
+}
+
+qint64 NfpCache::memoryUsage() const {
+    qint64 total = 0;
+    for (int i = 0; i <= shardMask_; ++i) {
+        QReadLocker locker(&shards_[i].lock);
+        total += shards_[i].table.bytes();
+    }
+    return total;
 }
 
 } // namespace Geometry
@@ -1,12 +1,19 @@
 #ifndef NFPCACHE_H
 #define NFPCACHE_H
 
-#include <QString>
-#include <QPolygonF>
+#include "nfpStats.h" // For Geometry::NfpStats
+#include "Clipper2/clipper.h" // For Clipper2Lib::Paths64
 #include <QList>
+#include <QVector>
+#include <QSharedPointer>
+#include <QReadWriteLock>
+#include <QAtomicInt>
 #include <QHash>
-#include <QPair> // For QPair used in key generation
 #include <QMutex>
+#include <QWaitCondition>
+#include <functional>
+#include <memory>
+#include <utility>
 
 namespace Geometry {
 
@@ -14,44 +21,204 @@ namespace Geometry {
 // An NFP can consist of multiple polygons (e.g., the main NFP and potentially others representing holes or sections).
 // Typically, for a pair of polygons A and B, the NFP represents the area where A cannot translate
 // without overlapping B, when A is placed relative to a reference point on B.
+// Coordinates are fixed-point at Configuration::clipperScale, like Core::InternalPart::outerPath64.
 struct CachedNfp {
-    QList<QPolygonF> nfpPolygons; // The NFP itself, could be multiple if complex
+    Clipper2Lib::Paths64 paths; // The NFP itself, could be multiple if complex
     // Add other relevant data if needed, e.g., source part IDs, rotations, etc. for debugging or advanced logic
     bool isValid = false; // Flag to indicate if this cache entry is valid / successfully computed
 
     CachedNfp() : isValid(false) {} // Default constructor
-    CachedNfp(const QList<QPolygonF>& polygons) : nfpPolygons(polygons), isValid(true) {}
+    CachedNfp(const Clipper2Lib::Paths64& nfpPaths) : paths(nfpPaths), isValid(true) {}
+    CachedNfp(Clipper2Lib::Paths64&& nfpPaths) : paths(std::move(nfpPaths)), isValid(true) {}
 };
 
+// Shared, immutable reference to a cached NFP. Lookups hand these out instead of
+// copying the polygons, so readers never hold a cache lock while using an NFP.
+typedef QSharedPointer<const CachedNfp> NfpHandle;
+
+// Cached NFP seen through a rigid transform. NFPs are computed with both parts at the origin,
+// and the static part unrotated. When the static part is rotated by 'rotation' degrees (about
+// its origin) and placed at 'offset', the NFP is rotated and moved the same way, so a view
+// pairs the shared polygons with that transform instead of copying transformed vertices.
+// Quarter turns are exact on the integer grid; other angles round to the nearest grid point.
+struct NfpView {
+    NfpHandle nfp;
+    Clipper2Lib::Point64 offset;
+    double rotation = 0.0; // Degrees, applied before the offset
+
+    NfpView() : cos_(1.0), sin_(0.0) {}
+    NfpView(const NfpHandle& handle, const Clipper2Lib::Point64& translation = Clipper2Lib::Point64(),
+            double rotationDegrees = 0.0);
+
+    bool isNull() const { return nfp.isNull(); }
+    // Maps a point in sheet coordinates into the coordinates of the shared paths.
+    Clipper2Lib::Point64 toLocal(const Clipper2Lib::Point64& point) const;
+    // Transformed copy of one path, for callers that need real vertices.
+    Clipper2Lib::Path64 path(size_t index) const;
+
+private:
+    double cos_;
+    double sin_;
+};
+
+// Compact identity of a cached NFP. Building one never allocates:
+// parts are referred to by their interned index (Core::InternalPart::cacheIndex)
+// and rotations are quantized to hundredths of a degree.
+// The first part is always the orbiting (or fitting) one, the second the static part or container.
+struct NfpKey {
+    enum Flag : quint8 {
+        FlippedA = 0x1,
+        FlippedB = 0x2,
+        Inside   = 0x4  // A fits inside B (inner NFP) rather than orbiting around it
+    };
+
+    quint32 partA = 0;
+    quint32 partB = 0;
+    quint16 rotationA = 0; // Hundredths of a degree in [0, 36000)
+    quint16 rotationB = 0;
+    quint8  flags = 0;
+
+    bool operator==(const NfpKey& other) const {
+        return partA == other.partA && partB == other.partB &&
+               rotationA == other.rotationA && rotationB == other.rotationB &&
+               flags == other.flags;
+    }
+    bool operator!=(const NfpKey& other) const { return !(*this == other); }
+
+    // 64-bit mix of all fields, used by the open-addressing table.
+    quint64 hash() const;
+
+    // Normalizes an angle in degrees to [0, 360) and quantizes it to hundredths of a degree.
+    static quint16 quantizeRotation(double degrees);
+};
+
+uint qHash(const NfpKey& key, uint seed = 0);
+
+// Flat open-addressing (linear probing) hash table from NfpKey to NfpHandle.
+// Slots live in one contiguous array; lookups hash two machine words and never allocate.
+// Each slot also carries its byte cost and a CLOCK usage counter for eviction.
+// Not thread-safe on its own, NfpCache serializes access per shard
+// (find() may run concurrently with other find() calls).
+class NfpTable {
+public:
+    explicit NfpTable(int initialCapacity = 256);
+
+    // Looks up 'key' and marks the entry as recently used.
+    const NfpHandle* find(const NfpKey& key) const;
+    // Looks up 'key' without affecting eviction.
+    const NfpHandle* peek(const NfpKey& key) const;
+    // Inserts or overwrites the entry for 'key', accounting 'cost' bytes for it.
+    void insert(const NfpKey& key, const NfpHandle& value, qint64 cost);
+    // Advances the CLOCK hand until an entry with no remaining usage is found and removes it.
+    // Returns the bytes freed, or 0 if the table is empty.
+    qint64 evictOne();
+    void clear();
+    int size() const { return size_; }
+    qint64 bytes() const { return bytes_; }
+
+private:
+    struct Slot {
+        NfpKey key;
+        NfpHandle value;
+        qint64 cost = 0;
+        mutable QAtomicInt usage; // CLOCK counter, refreshed by lookups under the shared lock
+        bool occupied = false;
+    };
+
+    QVector<Slot> slots_; // Capacity is always a power of two
+    int size_;
+    qint64 bytes_;
+    int clockHand_;
+
+    int probe(const NfpKey& key) const; // Index of the slot holding 'key', or of the empty slot ending its probe run
+    void removeAt(int index);
+    void grow();
+
+    // Inner NFPs (part vs. sheet) are needed by every placement, so they get extra
+    // CLOCK passes before they become eviction candidates.
+    static int usageWeight(const NfpKey& key) { return (key.flags & NfpKey::Inside) ? 3 : 1; }
+};
+
+// Thread-safe NFP cache shared by all fitness evaluation threads.
+// Entries are spread over a power-of-two number of shards, each with its own table and
+// read/write lock, so concurrent lookups of different keys rarely touch the same lock
+// and concurrent lookups of the same shard proceed in parallel under the read lock.
+// A single shard reproduces the classic one-lock cache.
+// getOrCompute() deduplicates concurrent misses: the first thread missing a key computes it,
+// later threads missing the same key wait for that result instead of computing it again.
+// With a positive memory budget each shard holds at most its share of the budget and
+// evicts with a weighted CLOCK policy that keeps frequently used and inner NFPs resident.
 class NfpCache {
 public:
-    NfpCache();
+    // shardCount <= 0 picks a count from QThread::idealThreadCount().
+    // memoryBudget is in bytes, 0 means unbounded.
+    explicit NfpCache(int shardCount = 1, qint64 memoryBudget = 0);
     ~NfpCache();
 
-    // Tries to retrieve an NFP from the cache.
-    // Returns true if found and populates 'result', false otherwise.
-    bool findNfp(const QString& key, CachedNfp& result) const;
+    // Returns a shared handle to the cached NFP, or a null handle if the key is
+    // missing or the stored entry is not valid. Counted as a hit or miss in stats().
+    NfpHandle findNfp(const NfpKey& key) const;
+    // Same test as findNfp() without touching the statistics or the eviction state.
+    bool contains(const NfpKey& key) const;
 
-    // Stores an NFP into the cache.
-    void storeNfp(const QString& key, const CachedNfp& nfp);
+    // Stores an NFP into the cache and returns the handle now held by the cache.
+    NfpHandle storeNfp(const NfpKey& key, const CachedNfp& nfp);
 
-    // Generates a unique key for an NFP based on part identifiers, rotations, and flip states.
-    // The order of partAId and partBId might matter depending on NFP definition (e.g., NFP(A,B) vs NFP(B,A)).
-    // For this implementation, we'll assume a canonical order or that the caller handles it.
-    // To ensure NFP(A,B) and NFP(B,A) are distinct or canonicalized before keygen:
-    // One common approach is to always sort part IDs alphabetically if the NFP is symmetric.
-    // However, if NFP(A,B) is for placing A around B, it's different from NFP(B,A).
-    // The `inside` flag (or similar context like "A inside B" vs "A around B") is also critical.
-    static QString generateKey(const QString& partAId, double rotationA, bool flippedA,
-                               const QString& partBId, double rotationB, bool flippedB,
-                               bool partAIsStatic); // partAIsStatic could differentiate A inside B vs B inside A, or similar context
+    // Returns the cached NFP for 'key', calling 'compute' on a miss and storing its result.
+    // Only one thread runs 'compute' for a given key at a time; threads that miss while it
+    // runs block until it finishes and share its result. If 'compute' throws, the exception
+    // reaches the computing thread and the waiting threads get a null handle.
+    NfpHandle getOrCompute(const NfpKey& key, const std::function<CachedNfp()>& compute);
+
+    // Builds the key for an NFP of part A (orbiting, or fitting inside when 'inside' is set)
+    // relative to part B (static). Part indices are the interned Core::InternalPart::cacheIndex values.
+    static NfpKey generateKey(int partAIndex, double rotationA, bool flippedA,
+                              int partBIndex, double rotationB, bool flippedB,
+                              bool inside);
+
+    // Approximate bytes held by an entry, derived from its polygon and vertex counts.
+    static qint64 entryCost(const CachedNfp& nfp);
 
     void clear(); // Clears the cache
     int size() const; // Returns the number of items in the cache
+    qint64 memoryUsage() const; // Accounted bytes over all shards
+    int shardCount() const { return shardMask_ + 1; }
+
+    // Hit/miss/wait/eviction counters, and the latency histograms NfpGenerator records into.
+    NfpStats& stats() const { return stats_; }
+    // stats() plus the current entry count, accounted bytes, budget and shard count.
+    QJsonObject statisticsJson() const;
 
 private:
-    QHash<QString, CachedNfp> cache_;
-    mutable QMutex mutex_; // Added for thread-safety
+    // Computation in progress for one key, shared by the computing thread and its waiters.
+    struct PendingNfp {
+        QMutex mutex;
+        QWaitCondition finished;
+        bool done = false;
+        NfpHandle result;
+    };
+
+    struct Shard {
+        mutable QReadWriteLock lock;
+        NfpTable table;
+        QHash<NfpKey, QSharedPointer<PendingNfp>> inFlight; // Guarded by 'lock'
+    };
+
+    std::unique_ptr<Shard[]> shards_;
+    int shardMask_;
+    qint64 shardBudget_; // Bytes per shard, 0 = unbounded
+    mutable NfpStats stats_;
+
+    // Inserts into the table and applies the budget. The shard's write lock must be held.
+    void insertLocked(Shard& shard, const NfpKey& key, const NfpHandle& handle, qint64 cost);
+    // Publishes the outcome of a computation to its waiters and retires it.
+    void finishPending(Shard& shard, const NfpKey& key, const QSharedPointer<PendingNfp>& pending,
+                       const NfpHandle& result);
+
+    // The table indexes slots with the low hash bits, shards use the high ones.
+    Shard& shardFor(const NfpKey& key) const {
+        return shards_[static_cast<int>(key.hash() >> 48) & shardMask_];
+    }
 };
 
 } // namespace Geometry
@@ -0,0 +1,349 @@
+#include "nfpDiskStore.h"
+#include <QFile>
+#include <QSaveFile>
+#include <QDir>
+#include <QUuid>
+#include <QMutexLocker>
+#include <QDebug>
+#include <QStringList>
+#include <algorithm>
+#include <cstring>
+#include <tuple>
+
+namespace Geometry {
+
+namespace {
+
+const char kSegmentMagic[4] = {'D', 'N', 'F', 'P'};
+const quint32 kSegmentVersion = 5; // 2: shapes keyed by canonical geometry fingerprint, 3: fixed-point paths,
+                                   // 4: NFPs are regions with holes (read with a non-zero fill),
+                                   // 5: original-module NFPs no longer reflected and shifted
+const quint32 kByteOrderMark = 0x01020304; // Segments are written in native byte order
+
+// On-disk layout of a segment:
+//   SegmentHeader
+//   IndexEntry[entryCount], sorted by key
+//   per entry, per path: quint64 vertexCount, then vertexCount x (qint64 x, qint64 y)
+struct SegmentHeader {
+    char magic[4];
+    quint32 version;
+    quint32 byteOrder;
+    quint32 profile;
+    quint32 entryCount;
+    quint32 reserved;
+    quint64 indexOffset;
+    double scale;         // Fixed-point scale of the stored coordinates
+};
+
+struct IndexEntry {
+    NfpDiskKey key;
+    quint64 dataOffset;
+    quint32 pathCount;
+    quint32 reserved;
+};
+
+static_assert(sizeof(NfpDiskKey) == 24, "NfpDiskKey is part of the segment format");
+static_assert(sizeof(SegmentHeader) == 40, "SegmentHeader is part of the segment format");
+static_assert(sizeof(IndexEntry) == 40, "IndexEntry is part of the segment format");
+
+} // namespace
+
+// --- NfpDiskKey ---
+
+NfpDiskKey NfpDiskKey::fromKey(const NfpKey& key, quint64 shapeA, quint64 shapeB) {
+    NfpDiskKey diskKey;
+    diskKey.shapeA = shapeA;
+    diskKey.shapeB = shapeB;
+    diskKey.rotationA = key.rotationA;
+    diskKey.rotationB = key.rotationB;
+    diskKey.flags = key.flags;
+    return diskKey;
+}
+
+bool NfpDiskKey::operator<(const NfpDiskKey& other) const {
+    return std::tie(shapeA, shapeB, rotationA, rotationB, flags) <
+           std::tie(other.shapeA, other.shapeB, other.rotationA, other.rotationB, other.flags);
+}
+
+bool NfpDiskKey::operator==(const NfpDiskKey& other) const {
+    return shapeA == other.shapeA && shapeB == other.shapeB &&
+           rotationA == other.rotationA && rotationB == other.rotationB &&
+           flags == other.flags;
+}
+
+// --- NfpDiskStore ---
+
+NfpDiskStore::NfpDiskStore(const QString& directory, quint32 profile, double scale, qint64 maxPendingBytes)
+    : directory_(directory), profile_(profile), scale_(scale), maxPendingBytes_(maxPendingBytes),
+      loaded_(0), unmappedSegments_(0) {
+}
+
+NfpDiskStore::~NfpDiskStore() {
+    unloadSegments();
+}
+
+void NfpDiskStore::unloadSegments() {
+    for (Segment& segment : segments_) {
+        segment.file->unmap(const_cast<uchar*>(segment.data));
+        delete segment.file;
+    }
+    segments_.clear();
+    loaded_.storeRelease(0);
+}
+
+void NfpDiskStore::ensureLoaded() const {
+    if (loaded_.loadAcquire()) return;
+    QMutexLocker locker(&loadMutex_);
+    if (loaded_.loadRelaxed()) return;
+
+    QDir dir(directory_);
+    const QStringList names = dir.entryList(QStringList() << QStringLiteral("*.seg"), QDir::Files, QDir::Time);
+    for (const QString& name : names) {
+        Segment segment;
+        if (openSegment(dir.filePath(name), segment)) {
+            segments_.append(segment);
+        }
+    }
+    qDebug() << "NfpDiskStore: mapped" << segments_.size() << "segments from" << directory_;
+    loaded_.storeRelease(1); // Segments are read-only from here on
+}
+
+bool NfpDiskStore::openSegment(const QString& path, Segment& segment) const {
+    QFile* file = new QFile(path);
+    if (!file->open(QIODevice::ReadOnly) || file->size() < static_cast<qint64>(sizeof(SegmentHeader))) {
+        delete file;
+        return false;
+    }
+    const qint64 size = file->size();
+    const uchar* data = file->map(0, size);
+    if (!data) {
+        qWarning() << "NfpDiskStore: could not map" << path;
+        delete file;
+        return false;
+    }
+
+    SegmentHeader header;
+    std::memcpy(&header, data, sizeof(header));
+    const bool valid = std::memcmp(header.magic, kSegmentMagic, sizeof(kSegmentMagic)) == 0 &&
+                       header.version == kSegmentVersion &&
+                       header.byteOrder == kByteOrderMark &&
+                       header.profile == profile_ &&
+                       header.scale == scale_ &&
+                       header.indexOffset % 8 == 0 &&
+                       header.indexOffset + static_cast<quint64>(header.entryCount) * sizeof(IndexEntry) <= static_cast<quint64>(size);
+    if (!valid) {
+        // Written by another format version, NFP backend profile or scale; leave it to its writers.
+        file->unmap(const_cast<uchar*>(data));
+        delete file;
+        return false;
+    }
+
+    segment.file = file;
+    segment.data = data;
+    segment.size = size;
+    segment.entryCount = header.entryCount;
+    segment.indexOffset = static_cast<qint64>(header.indexOffset);
+    return true;
+}
+
+Clipper2Lib::Paths64 NfpDiskEntry::toPaths() const {
+    Clipper2Lib::Paths64 paths;
+    paths.reserve(paths_.size());
+    for (const auto& path : paths_) {
+        paths.emplace_back(path.first, path.first + path.second);
+    }
+    return paths;
+}
+
+bool NfpDiskStore::readEntry(const Segment& segment, quint32 index, NfpDiskEntry& result) {
+    const IndexEntry& entry = reinterpret_cast<const IndexEntry*>(segment.data + segment.indexOffset)[index];
+    // Every read is bounds-checked against the segment size. Point64 is two int64 coordinates,
+    // the same layout as on disk, and all offsets are multiples of 8, so paths are used in place.
+    static_assert(sizeof(Clipper2Lib::Point64) == 2 * sizeof(qint64), "Point64 must match the segment layout");
+    const quint64 size = static_cast<quint64>(segment.size);
+    quint64 offset = entry.dataOffset;
+    result.paths_.clear();
+    result.paths_.reserve(entry.pathCount);
+    for (quint32 i = 0; i < entry.pathCount; ++i) {
+        if (offset > size || size - offset < sizeof(quint64)) return false;
+        quint64 vertexCount;
+        std::memcpy(&vertexCount, segment.data + offset, sizeof(vertexCount));
+        offset += sizeof(quint64);
+        if (vertexCount > (size - offset) / sizeof(Clipper2Lib::Point64)) return false;
+        result.paths_.emplace_back(reinterpret_cast<const Clipper2Lib::Point64*>(segment.data + offset),
+                                   static_cast<std::size_t>(vertexCount));
+        offset += vertexCount * sizeof(Clipper2Lib::Point64);
+    }
+    return true;
+}
+
+bool NfpDiskStore::findInSegment(const Segment& segment, const NfpDiskKey& key, NfpDiskEntry& result) const {
+    const IndexEntry* begin = reinterpret_cast<const IndexEntry*>(segment.data + segment.indexOffset);
+    const IndexEntry* end = begin + segment.entryCount;
+    const IndexEntry* entry = std::lower_bound(begin, end, key,
+        [](const IndexEntry& e, const NfpDiskKey& k) { return e.key < k; });
+    if (entry == end || !(entry->key == key)) {
+        return false;
+    }
+    return readEntry(segment, static_cast<quint32>(entry - begin), result);
+}
+
+bool NfpDiskStore::find(const NfpDiskKey& key, NfpDiskEntry& result) const {
+    if (!isEnabled()) return false;
+    ensureLoaded();
+    for (const Segment& segment : segments_) {
+        if (findInSegment(segment, key, result)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+void NfpDiskStore::record(const NfpDiskKey& key, const NfpHandle& nfp) {
+    // An empty NFP is a failed computation (every pair of real parts has one); stored, it would
+    // be reused as a valid result by every later run sharing the directory.
+    if (!isEnabled() || nfp.isNull() || !nfp->isValid || nfp->paths.empty()) return;
+    QList<PendingItem> entries;
+    {
+        QMutexLocker locker(&pendingMutex_);
+        pending_.append(qMakePair(key, nfp));
+        pendingBytes_ += NfpCache::entryCost(*nfp);
+        if (pendingBytes_ <= maxPendingBytes_) return;
+        entries.swap(pending_);
+        pendingBytes_ = 0;
+    }
+    // Written outside the lock, without touching the mapped segments, so lookups and other
+    // records carry on meanwhile. A failed write drops these NFPs; they are computed again.
+    QList<SegmentItem> items;
+    appendPending(entries, items);
+    if (writeItems(items)) unmappedSegments_.ref();
+}
+
+void NfpDiskStore::appendPending(const QList<PendingItem>& entries, QList<SegmentItem>& items) {
+    for (const PendingItem& entry : entries) {
+        NfpDiskEntry view;
+        for (const Clipper2Lib::Path64& path : entry.second->paths) view.paths_.emplace_back(path.data(), path.size());
+        items.append(qMakePair(entry.first, view));
+    }
+}
+
+bool NfpDiskStore::flush() {
+    if (!isEnabled()) return true;
+
+    QList<PendingItem> entries;
+    {
+        QMutexLocker locker(&pendingMutex_);
+        entries.swap(pending_);
+        pendingBytes_ = 0;
+    }
+    if (unmappedSegments_.fetchAndStoreRelaxed(0) > 0) {
+        unloadSegments(); // Map the segments record() wrote, so they are counted and merged
+    }
+    ensureLoaded();
+    const bool compact = segments_.size() + (entries.isEmpty() ? 0 : 1) > kMaxSegments;
+    if (entries.isEmpty() && !compact) return true;
+
+    // Newest first: the queued NFPs, then the segments in their lookup order. After a stable sort
+    // by key the first item of each key is the one find() would have returned.
+    QList<SegmentItem> items;
+    appendPending(entries, items);
+    QStringList merged;
+    if (compact) {
+        for (const Segment& segment : segments_) {
+            const IndexEntry* index = reinterpret_cast<const IndexEntry*>(segment.data + segment.indexOffset);
+            for (quint32 i = 0; i < segment.entryCount; ++i) {
+                NfpDiskEntry view;
+                if (readEntry(segment, i, view)) items.append(qMakePair(index[i].key, view));
+            }
+            merged.append(segment.file->fileName());
+        }
+    }
+    if (!writeItems(items)) return false;
+    // Remapped on the next lookup, new segment included.
+    unloadSegments();
+    if (compact) {
+        // The merged files are now covered by the new segment. Another process may remove them
+        // first, or (on Windows) still have them mapped; either way they are merged again later.
+        for (const QString& path : merged) QFile::remove(path);
+        qDebug() << "NfpDiskStore: compacted" << merged.size() << "segments into one";
+    }
+    return true;
+}
+
+bool NfpDiskStore::writeItems(QList<SegmentItem>& items) {
+    std::stable_sort(items.begin(), items.end(),
+        [](const SegmentItem& a, const SegmentItem& b) { return a.first < b.first; });
+    items.erase(std::unique(items.begin(), items.end(),
+        [](const SegmentItem& a, const SegmentItem& b) { return a.first == b.first; }),
+        items.end());
+
+    if (!QDir().mkpath(directory_)) {
+        qWarning() << "NfpDiskStore: could not create" << directory_;
+        return false;
+    }
+    return writeSegment(items);
+}
+
+bool NfpDiskStore::writeSegment(const QList<SegmentItem>& items) {
+    SegmentHeader header;
+    std::memcpy(header.magic, kSegmentMagic, sizeof(kSegmentMagic));
+    header.version = kSegmentVersion;
+    header.byteOrder = kByteOrderMark;
+    header.profile = profile_;
+    header.entryCount = static_cast<quint32>(items.size());
+    header.reserved = 0;
+    header.indexOffset = sizeof(SegmentHeader);
+    header.scale = scale_;
+
+    // Offsets are 64-bit and everything is written straight to the file, so neither the
+    // segment nor a single NFP is limited to what one QByteArray can hold.
+    std::vector<IndexEntry> index(static_cast<std::size_t>(items.size()));
+    quint64 dataOffset = header.indexOffset + static_cast<quint64>(items.size()) * sizeof(IndexEntry);
+    for (int i = 0; i < items.size(); ++i) {
+        const NfpDiskEntry& entry = items[i].second;
+        IndexEntry& indexEntry = index[static_cast<std::size_t>(i)];
+        indexEntry.key = items[i].first;
+        indexEntry.dataOffset = dataOffset;
+        indexEntry.pathCount = static_cast<quint32>(entry.pathCount());
+        indexEntry.reserved = 0;
+        for (int path = 0; path < entry.pathCount(); ++path) {
+            dataOffset += sizeof(quint64) + static_cast<quint64>(entry.vertexCount(path)) * sizeof(Clipper2Lib::Point64);
+        }
+    }
+
+    // QSaveFile writes to a temporary file and renames it on commit, so readers in
+    // other processes never map a partially written segment.
+    const QString name = QStringLiteral("nfp-%1.seg").arg(QUuid::createUuid().toString(QUuid::WithoutBraces));
+    QSaveFile file(QDir(directory_).filePath(name));
+    if (!file.open(QIODevice::WriteOnly)) {
+        qWarning() << "NfpDiskStore: could not open" << file.fileName() << "for writing";
+        return false;
+    }
+    auto write = [&file](const void* data, qint64 size) {
+        return file.write(reinterpret_cast<const char*>(data), size) == size;
+    };
+    bool written = write(&header, sizeof(header)) &&
+                   write(index.data(), static_cast<qint64>(index.size() * sizeof(IndexEntry)));
+    for (int i = 0; written && i < items.size(); ++i) {
+        const NfpDiskEntry& entry = items[i].second;
+        for (int path = 0; written && path < entry.pathCount(); ++path) {
+            const quint64 vertexCount = static_cast<quint64>(entry.vertexCount(path));
+            written = write(&vertexCount, sizeof(vertexCount)) &&
+                      write(entry.vertices(path), static_cast<qint64>(vertexCount * sizeof(Clipper2Lib::Point64)));
+        }
+    }
+    if (!written || !file.commit()) {
+        qWarning() << "NfpDiskStore: could not write" << file.fileName();
+        return false;
+    }
+    qDebug() << "NfpDiskStore: wrote" << items.size() << "NFPs to" << name;
+    return true;
+}
+
+int NfpDiskStore::segmentCount() const {
+    if (!isEnabled()) return 0;
+    ensureLoaded();
+    return segments_.size();
+}
+
+} // namespace Geometry
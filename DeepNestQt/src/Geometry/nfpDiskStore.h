@@ -0,0 +1,134 @@
+#ifndef NFPDISKSTORE_H
+#define NFPDISKSTORE_H
+
+#include "nfpCache.h" // For Geometry::NfpKey, Geometry::CachedNfp, Geometry::NfpHandle
+#include <QString>
+#include <QList>
+#include <QPair>
+#include <QMutex>
+#include <QAtomicInt>
+#include <cstddef>
+#include <utility>
+#include <vector>
+
+class QFile;
+
+namespace Geometry {
+
+// Identity of an NFP in the persistent store. Unlike NfpKey, the parts are identified
+// by their geometry fingerprint, which is stable across runs and processes.
+// Fixed 24-byte layout, written to disk as is.
+struct NfpDiskKey {
+    quint64 shapeA = 0;
+    quint64 shapeB = 0;
+    quint16 rotationA = 0; // Same quantization as NfpKey
+    quint16 rotationB = 0;
+    quint8  flags = 0;     // NfpKey::Flag bits
+    quint8  reserved[3] = {0, 0, 0};
+
+    static NfpDiskKey fromKey(const NfpKey& key, quint64 shapeA, quint64 shapeB);
+
+    bool operator<(const NfpDiskKey& other) const;
+    bool operator==(const NfpDiskKey& other) const;
+};
+
+// Stored NFP read in place: path i is vertexCount(i) points starting at vertices(i), inside a
+// mapped segment (or inside the paths of a queued NFP while a segment is written).
+// Found entries stay valid while the store exists and until its next flush(). The NFP cache
+// keeps a copy (toPaths()): its entries are Paths64 handed straight to Clipper2, and they must
+// outlive the compaction in flush(), which unmaps the segments. The mapping saves reading and
+// decoding the file, not that copy.
+class NfpDiskEntry {
+public:
+    int pathCount() const { return static_cast<int>(paths_.size()); }
+    std::size_t vertexCount(int path) const { return paths_[static_cast<std::size_t>(path)].second; }
+    const Clipper2Lib::Point64* vertices(int path) const { return paths_[static_cast<std::size_t>(path)].first; }
+    // Owned copy, for the in-memory cache.
+    Clipper2Lib::Paths64 toPaths() const;
+
+private:
+    friend class NfpDiskStore;
+    std::vector<std::pair<const Clipper2Lib::Point64*, std::size_t>> paths_;
+};
+
+// Persistent NFP store shared by all runs (and all nesting processes) on a machine.
+//
+// The store is a directory of immutable segment files. Each segment holds a header,
+// an index sorted by NfpDiskKey and the vertex data. Segments are memory-mapped on the
+// first lookup and searched in place; nothing is parsed up front, and a hit points into the
+// mapping instead of decoding a copy.
+// New NFPs are queued during a run and written as a new segment through QSaveFile, so a segment
+// only becomes visible once complete. The queue holds handles to the NFPs, which keeps them in
+// memory after the cache evicts them, so record() writes it out as soon as it holds more than
+// 'maxPendingBytes'; those segments are mapped from the next flush() on, which writes the rest. Since segments are never
+// modified, any number of processes can map and read them concurrently. Once there would be
+// more than kMaxSegments, flush() merges them all into one (newest entry per key wins) and
+// removes the merged files, so the directory does not grow a segment per run.
+//
+// 'profile' tags segments with the NFP backend settings and 'scale' is the fixed-point scale of
+// the stored paths; segments written with a different profile, scale or format version are ignored.
+class NfpDiskStore {
+public:
+    static const int kMaxSegments = 8;
+    static const qint64 kDefaultMaxPendingBytes = 32 * 1024 * 1024;
+
+    NfpDiskStore(const QString& directory, quint32 profile, double scale,
+                 qint64 maxPendingBytes = kDefaultMaxPendingBytes);
+    ~NfpDiskStore();
+
+    bool isEnabled() const { return !directory_.isEmpty(); }
+
+    // Looks the key up in all mapped segments, newest first. Thread-safe.
+    bool find(const NfpDiskKey& key, NfpDiskEntry& result) const;
+
+    // Queues a freshly computed NFP (empty ones are failures and skipped), writing the queue as a segment once it holds more than
+    // maxPendingBytes (NfpCache::entryCost). Thread-safe, and safe alongside find().
+    void record(const NfpDiskKey& key, const NfpHandle& nfp);
+
+    // Writes all queued NFPs into a new segment, compacting the segments when there are too many.
+    // Returns false on I/O errors. Must not run concurrently with find(): a compaction unmaps the
+    // merged segments, which invalidates the entries found before.
+    bool flush();
+
+    int segmentCount() const;
+
+private:
+    struct Segment {
+        QFile* file = nullptr;
+        const uchar* data = nullptr;
+        qint64 size = 0;
+        quint32 entryCount = 0;
+        qint64 indexOffset = 0;
+    };
+    typedef QPair<NfpDiskKey, NfpDiskEntry> SegmentItem;
+    typedef QPair<NfpDiskKey, NfpHandle> PendingItem;
+
+    QString directory_;
+    quint32 profile_;
+    double scale_;
+    qint64 maxPendingBytes_;
+
+    mutable QMutex loadMutex_;
+    mutable QAtomicInt loaded_;
+    mutable QList<Segment> segments_;
+
+    mutable QMutex pendingMutex_;
+    QList<PendingItem> pending_;
+    qint64 pendingBytes_ = 0;
+    QAtomicInt unmappedSegments_; // Written by record() since the last flush()
+
+    void ensureLoaded() const;
+    void unloadSegments();
+    bool openSegment(const QString& path, Segment& segment) const;
+    // Reads the entry at 'index' of the segment; false if its data runs past the end of the file.
+    static bool readEntry(const Segment& segment, quint32 index, NfpDiskEntry& result);
+    bool findInSegment(const Segment& segment, const NfpDiskKey& key, NfpDiskEntry& result) const;
+    static void appendPending(const QList<PendingItem>& entries, QList<SegmentItem>& items);
+    // Keeps the first item of each key and writes them as a new segment.
+    bool writeItems(QList<SegmentItem>& items);
+    // Writes 'items' (sorted by key, unique) as a new segment.
+    bool writeSegment(const QList<SegmentItem>& items);
+};
+
+} // namespace Geometry
+#endif // NFPDISKSTORE_H
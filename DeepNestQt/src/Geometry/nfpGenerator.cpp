@@ -1,8 +1,13 @@
 #include "nfpGenerator.h"
 #include "Clipper2/clipper.h"
 #include "minkowski_wrapper.h" // Added for CustomMinkowski
+#include "minkowski_thread_wrapper.h" // For CustomMinkowski::CalculateNfp_Batch_MultiThreaded
+#include "geometryUtils.h"     // For GeometryUtils::minkowskiSumConvex, GeometryUtils::convexDecomposition, region sums
+#include "orbitalNfp.h"
 #include <QDebug>
-#include <algorithm> 
+#include <QElapsedTimer>
+#include <algorithm>
+#include <cmath>
 
 namespace Geometry {
 
@@ -15,15 +20,15 @@ NfpGenerator::NfpGenerator(double clipperScale) : scale_(clipperScale) {
 
 NfpGenerator::~NfpGenerator() {}
 
-// Helper function to convert Core::InternalPart to CustomMinkowski::PolygonWithHoles
+// Helper function to convert Core::InternalPart to CustomMinkowski::PolygonWithHoles.
+// The fixed-point paths are converted back to part units; CalculateNfp applies its own per-pair scale.
 CustomMinkowski::PolygonWithHoles internalPartToMinkowskiPolygon(const Core::InternalPart& part, double scale) {
     CustomMinkowski::PolygonWithHoles mPoly;
     // Outer boundary
-    if (!part.outerBoundary.isEmpty()) {
-        mPoly.outer.reserve(part.outerBoundary.size());
-        for (const QPointF& pt : part.outerBoundary) {
-            mPoly.outer.push_back({pt.x() /* * scale -> scaling done by CustomMinkowski::CalculateNfp */, 
-                                   pt.y() /* * scale */});
+    if (!part.outerPath64.empty()) {
+        mPoly.outer.reserve(part.outerPath64.size());
+        for (const Clipper2Lib::Point64& pt : part.outerPath64) {
+            mPoly.outer.push_back({static_cast<double>(pt.x) / scale, static_cast<double>(pt.y) / scale});
         }
         // Note: Orientation for Boost.Polygon is typically CCW for outer, CW for holes.
         // Assuming InternalPart already provides this, or CalculateNfp handles it.
@@ -31,13 +36,12 @@ CustomMinkowski::PolygonWithHoles internalPartToMinkowskiPolygon(const Core::Int
     }
 
     // Holes
-    for (const QPolygonF& holeQPoly : part.holes) {
-        if (!holeQPoly.isEmpty()) {
+    for (const Clipper2Lib::Path64& hole : part.holesPath64) {
+        if (!hole.empty()) {
             CustomMinkowski::PolygonPath mHole;
-            mHole.reserve(holeQPoly.size());
-            for (const QPointF& pt : holeQPoly) {
-                mHole.push_back({pt.x() /* * scale */, 
-                                 pt.y() /* * scale */});
+            mHole.reserve(hole.size());
+            for (const Clipper2Lib::Point64& pt : hole) {
+                mHole.push_back({static_cast<double>(pt.x) / scale, static_cast<double>(pt.y) / scale});
             }
             mPoly.holes.push_back(mHole);
         }
@@ -45,227 +49,350 @@ CustomMinkowski::PolygonWithHoles internalPartToMinkowskiPolygon(const Core::Int
     return mPoly;
 }
 
-// Helper function to convert CustomMinkowski::NfpResultPolygons to QList<QPolygonF>
-QList<QPolygonF> minkowskiResultToQPolygonFs(const CustomMinkowski::NfpResultPolygons& resultPaths, double scale_to_reverse_if_needed_by_wrapper) {
-    QList<QPolygonF> qPolygons;
-    // The scale_to_reverse_if_needed_by_wrapper is if the CustomMinkowski::CalculateNfp returns scaled coordinates.
-    // Based on its current refactored signature, it takes scaled inputs and should return unscaled (double) outputs.
-    // So, direct conversion. If it returned scaled ints, we'd divide by scale_to_reverse_if_needed_by_wrapper.
-    // The current wrapper's CalculateNfp takes double points and a scale, and it's assumed it handles scaling internally
-    // and the points in NfpResultPolygons are already in the original double coordinate space.
-    // However, the provided `minkowski_wrapper.cpp` implementation for CalculateNfp *does* do the scaling/unscaling.
-    // The points in NfpResultPolygons are already unscaled and shifted by xshift/yshift.
-
+// Helper function to convert CustomMinkowski::NfpResultPolygons (unscaled by the wrapper)
+// to fixed-point paths at 'scale'.
+Clipper2Lib::Paths64 minkowskiResultToPaths64(const CustomMinkowski::NfpResultPolygons& resultPaths, double scale) {
+    Clipper2Lib::Paths64 paths;
+    paths.reserve(resultPaths.size());
     for (const CustomMinkowski::PolygonPath& mPath : resultPaths) {
-        QPolygonF qPoly;
-        qPoly.reserve(mPath.size());
+        Clipper2Lib::Path64 path;
+        path.reserve(mPath.size());
         for (const CustomMinkowski::Point& pt : mPath) {
-            qPoly.append(QPointF(pt.x , pt.y )); // Direct use, as they should be unscaled by wrapper
+            path.push_back(Clipper2Lib::Point64(pt.x * scale, pt.y * scale));
         }
-        if (!qPoly.isEmpty()) {
-            qPolygons.append(qPoly);
+        if (!path.empty()) {
+            paths.push_back(std::move(path));
         }
     }
-    return qPolygons;
+    return paths;
 }
 
-Clipper2Lib::PathD NfpGenerator::qPolygonFToPathD(const QPolygonF& polygon) const {
-    Clipper2Lib::PathsD paths;
-    Clipper2Lib::PathD path;
-    for (const QPointF& pt : polygon) {
-        // For Clipper2, we use its own scaling mechanism if needed, or pass doubles directly.
-        // Assuming NfpGenerator's scale_ is for integer-based operations like Boost.Polygon might use.
-        // Clipper2Lib::PointD typically takes doubles.
-        path.push_back(Clipper2Lib::PointD(pt.x(), pt.y()));
+// Point reflection through the origin keeps the orientation, so only the coordinates are negated.
+static Clipper2Lib::Path64 reflectPathAroundOrigin(const Clipper2Lib::Path64& path) {
+    Clipper2Lib::Path64 reflected;
+    reflected.reserve(path.size());
+    for (const Clipper2Lib::Point64& p : path) {
+        reflected.push_back(Clipper2Lib::Point64(-p.x, -p.y));
     }
+    return reflected;
+}
 
-    return path;
+
+// The part's material as a region (outer counter-clockwise, holes clockwise).
+static Clipper2Lib::Paths64 partRegion(const Core::InternalPart& part) {
+    return GeometryUtils::orientedRegion(part.outerPath64, part.holesPath64);
 }
 
-Clipper2Lib::PathsD NfpGenerator::qPolygonFToPathsD(const QPolygonF& polygon) const {
-    Clipper2Lib::PathsD paths;
-    Clipper2Lib::PathD path;
-    for (const QPointF& pt : polygon) {
-        // For Clipper2, we use its own scaling mechanism if needed, or pass doubles directly.
-        // Assuming NfpGenerator's scale_ is for integer-based operations like Boost.Polygon might use.
-        // Clipper2Lib::PointD typically takes doubles.
-        path.push_back(Clipper2Lib::PointD(pt.x(), pt.y()));
+static Clipper2Lib::Paths64 reflectPathsAroundOrigin(const Clipper2Lib::Paths64& paths) {
+    Clipper2Lib::Paths64 reflected;
+    reflected.reserve(paths.size());
+    for (const Clipper2Lib::Path64& path : paths) {
+        reflected.push_back(reflectPathAroundOrigin(path));
     }
-    if (!path.empty()) {
-        paths.push_back(path);
+    return reflected;
+}
+
+Clipper2Lib::Paths64 NfpGenerator::minkowskiNfp(const Core::InternalPart& partA_orbiting, const Core::InternalPart& partB_static) {
+    if (partA_orbiting.outerPath64.empty() || partB_static.outerPath64.empty()) {
+        qWarning() << "NfpGenerator::minkowskiNfp: Invalid input parts.";
+        return Clipper2Lib::Paths64();
     }
-    return paths;
+
+    // NFP(A, B) = B (+) reflect(A), both with their holes. Where A fits inside a hole of B (or B
+    // inside a hole of A) the sum keeps a hole: those positions are free, which is what lets
+    // small parts nest inside the cutouts of larger ones.
+    // Both operands are already at scale_, so the integer overloads run without any conversion.
+    return GeometryUtils::minkowskiSumRegions(partRegion(partB_static), reflectPathsAroundOrigin(partRegion(partA_orbiting)));
 }
 
-Clipper2Lib::PathsD NfpGenerator::qPolygonFsToPathsD(const QList<QPolygonF>& polygons) const {
-    Clipper2Lib::PathsD paths;
-    for(const QPolygonF& polygon : polygons) {
-        Clipper2Lib::PathD path;
-        for (const QPointF& pt : polygon) {
-            path.push_back(Clipper2Lib::PointD(pt.x(), pt.y()));
-        }
-        if (!path.empty()) {
-             paths.push_back(path);
-        }
+Clipper2Lib::Paths64 NfpGenerator::convexNfp(const Core::InternalPart& partA_orbiting, const Core::InternalPart& partB_static) {
+    // NFP(A, B) = B (+) reflect(A); reflecting a convex part keeps it convex.
+    Clipper2Lib::Path64 nfp = GeometryUtils::minkowskiSumConvex(partB_static.outerPath64,
+                                                               reflectPathAroundOrigin(partA_orbiting.outerPath64));
+    Clipper2Lib::Paths64 result;
+    if (!nfp.empty()) {
+        result.push_back(std::move(nfp));
     }
-    return paths;
+    return result;
 }
 
+Clipper2Lib::Paths64 NfpGenerator::decompositionNfp(const Core::InternalPart& partA_orbiting, const Core::InternalPart& partB_static) {
+    if (partA_orbiting.convexPieces.empty() || partB_static.convexPieces.empty()) {
+        return Clipper2Lib::Paths64();
+    }
+    // The pieces cover the outer boundary only; a union of their sums would fill the holes in.
+    if (!partA_orbiting.holesPath64.empty() || !partB_static.holesPath64.empty()) {
+        return Clipper2Lib::Paths64();
+    }
 
-QList<QPolygonF> NfpGenerator::pathsDToQPolygonFs(const Clipper2Lib::PathsD& paths) const {
-    QList<QPolygonF> qPolygons;
-    for (const Clipper2Lib::PathD& path : paths) {
-        QPolygonF qPolygon;
-        for (const Clipper2Lib::PointD& pt : path) {
-            qPolygon.append(QPointF(pt.x, pt.y));
-        }
-        if (!qPolygon.isEmpty()) {
-             qPolygons.append(qPolygon);
+    // B (+) reflect(A) = union over the piece pairs of Bj (+) reflect(Ai); each term is a linear merge.
+    Clipper2Lib::Paths64 sums;
+    sums.reserve(partA_orbiting.convexPieces.size() * partB_static.convexPieces.size());
+    for (const Clipper2Lib::Path64& pieceA : partA_orbiting.convexPieces) {
+        const Clipper2Lib::Path64 reflectedPiece = reflectPathAroundOrigin(pieceA);
+        for (const Clipper2Lib::Path64& pieceB : partB_static.convexPieces) {
+            Clipper2Lib::Path64 sum = GeometryUtils::minkowskiSumConvex(pieceB, reflectedPiece);
+            if (!sum.empty()) {
+                sums.push_back(std::move(sum));
+            }
         }
     }
-    return qPolygons;
+    if (sums.empty()) {
+        return Clipper2Lib::Paths64();
+    }
+    return Clipper2Lib::Union(sums, Clipper2Lib::FillRule::NonZero);
 }
 
-Core::InternalPart reflectPartAroundOrigin(const Core::InternalPart& part) {
-    Core::InternalPart reflectedPart;
-    reflectedPart.id = part.id + "_reflected";
-    QPolygonF reflectedOuter;
-    for(const QPointF& p : part.outerBoundary) {
-        reflectedOuter.append(QPointF(-p.x(), -p.y()));
+// Fixed-point path to document units, counter-clockwise as OrbitalNfp expects.
+static Clipper2Lib::PathD toOrbitalPath(const Clipper2Lib::Path64& path, double scale) {
+    Clipper2Lib::PathD result;
+    result.reserve(path.size());
+    for (const Clipper2Lib::Point64& p : path) {
+        result.push_back(Clipper2Lib::PointD(static_cast<double>(p.x) / scale, static_cast<double>(p.y) / scale));
     }
-    if(!reflectedOuter.isEmpty()) std::reverse(reflectedOuter.begin(), reflectedOuter.end());
-    reflectedPart.outerBoundary = reflectedOuter;
-
-    for(const QPolygonF& hole : part.holes) {
-        QPolygonF reflectedHole;
-        for(const QPointF& p : hole) {
-            reflectedHole.append(QPointF(-p.x(), -p.y()));
-        }
-        if(!reflectedHole.isEmpty()) std::reverse(reflectedHole.begin(), reflectedHole.end());
-        reflectedPart.holes.append(reflectedHole);
+    if (Clipper2Lib::Area(result) < 0) {
+        std::reverse(result.begin(), result.end());
     }
-    if(!reflectedPart.outerBoundary.isEmpty()) reflectedPart.bounds = reflectedPart.outerBoundary.boundingRect();
-    return reflectedPart;
+    return result;
 }
 
+Clipper2Lib::Paths64 NfpGenerator::orbitalNfp(const Core::InternalPart& partA_orbiting, const Core::InternalPart& partB_static, bool inside) {
+    if (partA_orbiting.outerPath64.size() < 3 || partB_static.outerPath64.size() < 3) {
+        return Clipper2Lib::Paths64();
+    }
+    // The orbit only follows outer boundaries. B sitting in a hole of A has no orbit to trace,
+    // so those pairs are left to the region sum.
+    if (!inside && !partA_orbiting.holesPath64.empty()) {
+        return Clipper2Lib::Paths64();
+    }
+    // B stays put and A orbits it, so the loops trace A's origin.
+    const Clipper2Lib::PathD staticPath = toOrbitalPath(partB_static.outerPath64, scale_);
+    const Clipper2Lib::PathsD loops = OrbitalNfp::noFitPolygon(staticPath, toOrbitalPath(partA_orbiting.outerPath64, scale_),
+                                                               inside, exploreConcave_);
+    if (loops.empty()) {
+        return Clipper2Lib::Paths64();
+    }
+    // A complete outer orbit encloses B; anything smaller is a broken loop.
+    if (!inside && std::abs(Clipper2Lib::Area(loops.front())) < std::abs(Clipper2Lib::Area(staticPath))) {
+        return Clipper2Lib::Paths64();
+    }
 
-QList<QPolygonF> NfpGenerator::minkowskiNfp(const Core::InternalPart& partA_orbiting, const Core::InternalPart& partB_static) {
-    if (!partA_orbiting.isValid() || !partB_static.isValid()) {
-        qWarning() << "NfpGenerator::minkowskiNfp: Invalid input parts.";
-        return QList<QPolygonF>();
+    Clipper2Lib::Paths64 result;
+    result.reserve(loops.size());
+    for (size_t i = 0; i < loops.size(); ++i) {
+        Clipper2Lib::Path64 path;
+        path.reserve(loops[i].size());
+        for (const Clipper2Lib::PointD& p : loops[i]) {
+            path.push_back(Clipper2Lib::Point64(p.x * scale_, p.y * scale_));
+        }
+        // Outer: the first loop bounds the NFP and interlocking loops are holes in it. Inner: all regions.
+        const bool positive = inside || i == 0;
+        if ((Clipper2Lib::Area(path) > 0) != positive) {
+            std::reverse(path.begin(), path.end());
+        }
+        result.push_back(std::move(path));
     }
-    
-    Clipper2Lib::PathD pathsB_outer = qPolygonFToPathD(partB_static.outerBoundary);
-    Core::InternalPart reflectedA = reflectPartAroundOrigin(partA_orbiting);
-    Clipper2Lib::PathD pathsReflectedA_outer = qPolygonFToPathD(reflectedA.outerBoundary);
-
-    // TODO: Properly handle holes for Minkowski sum with Clipper2.
-    // This typically involves treating the part as (Outer - Holes).
-    // For NFP(A,B) = B (+) reflect(A):
-    // B_shape = B_outer - Union(B_holes)
-    // ReflectedA_shape = ReflectedA_outer - Union(ReflectedA_holes)
-    // NFP = MinkowskiSum(B_shape, ReflectedA_shape)
-    // Clipper2's MinkowskiSum works on Paths. If a part is (Outer - Holes), it should be represented as such.
-    // For now, using outer boundaries only is a simplification.
-
-    Clipper2Lib::PathsD nfpPaths = Clipper2Lib::MinkowskiSum(pathsB_outer, pathsReflectedA_outer, false); 
-    //qDebug() << "Clipper2 MinkowskiSum for NFP(A around B) produced" << nfpPaths.size() << "paths.";
-    return pathsDToQPolygonFs(nfpPaths);
+
+    if (!inside) {
+        // As in the JS getOuterNfp/getInnerNfp pair: every hole of B large enough for A adds
+        // the positions inside it, which are holes of the outer NFP.
+        for (const Clipper2Lib::Path64& hole : partB_static.holesPath64) {
+            Core::InternalPart holeContainer;
+            holeContainer.id = partB_static.id;
+            holeContainer.outerPath64 = hole;
+            for (Clipper2Lib::Path64& path : orbitalNfp(partA_orbiting, holeContainer, true)) {
+                std::reverse(path.begin(), path.end());
+                result.push_back(std::move(path));
+            }
+        }
+    } else if (!partB_static.holesPath64.empty()) {
+        // Holes of the container (sheet cutouts) are obstacles: remove the positions where A overlaps one.
+        const Clipper2Lib::Paths64 reflectedA = reflectPathsAroundOrigin(partRegion(partA_orbiting));
+        Clipper2Lib::Paths64 forbidden;
+        for (const Clipper2Lib::Path64& hole : partB_static.holesPath64) {
+            const Clipper2Lib::Paths64 sum = GeometryUtils::minkowskiSumRegions(
+                GeometryUtils::orientedRegion(hole, Clipper2Lib::Paths64()), reflectedA);
+            forbidden.insert(forbidden.end(), sum.begin(), sum.end());
+        }
+        result = Clipper2Lib::Difference(result, forbidden, Clipper2Lib::FillRule::NonZero);
+    }
+    return result;
 }
 
-QList<QPolygonF> NfpGenerator::minkowskiNfpInside(const Core::InternalPart& partA_fitting, const Core::InternalPart& partB_container) {
-     if (!partA_fitting.isValid() || !partB_container.isValid()) {
+Clipper2Lib::Paths64 NfpGenerator::minkowskiNfpInside(const Core::InternalPart& partA_fitting, const Core::InternalPart& partB_container) {
+    if (partA_fitting.outerPath64.empty() || partB_container.outerPath64.empty()) {
         qWarning() << "NfpGenerator::minkowskiNfpInside: Invalid input parts.";
-        return QList<QPolygonF>();
+        return Clipper2Lib::Paths64();
     }
-    
-    // NFP_inside(A, B) = B_outer (-) A_outer (Minkowski Difference)
-    // This is for A's reference point. A is NOT reflected for this definition.
-    Clipper2Lib::PathD pathsB_outer = qPolygonFToPathD(partB_container.outerBoundary);
-    Clipper2Lib::PathD pathsA_outer = qPolygonFToPathD(partA_fitting.outerBoundary); // partA is not reflected
-
-    // TODO: Properly handle holes for Inner NFP.
-    // Inner NFP = (B_outer (-) A_outer) intersected with (For each hole H_b in B: H_b (+) Reflect(A_outer))
-    // This is complex. The current is a simplification.
-
-    Clipper2Lib::PathsD nfpPaths = Clipper2Lib::MinkowskiDiff(pathsB_outer, pathsA_outer, false);
-    //qDebug() << "Clipper2 MinkowskiDiff for NFP(A inside B) produced" << nfpPaths.size() << "paths.";
-    return pathsDToQPolygonFs(nfpPaths);
+
+    // Positions of A's reference point with all of A inside B's material. B's holes (sheet cutouts)
+    // come out as holes of the region, so they are forbidden like obstacles.
+    return GeometryUtils::minkowskiInnerRegion(partRegion(partB_container), partRegion(partA_fitting));
 }
 
 
-QList<QPolygonF> NfpGenerator::originalModuleNfp(const Core::InternalPart& partA_orbiting,
+Clipper2Lib::Paths64 NfpGenerator::originalModuleNfp(const Core::InternalPart& partA_orbiting,
                                                      const Core::InternalPart& partB_static,
                                                      bool isInside, 
                                                      bool useThreads) {
-    if (useThreads) {
-        qWarning() << "NfpGenerator::originalModuleNfp: Multi-threaded version of custom Minkowski module is not available/integrated. Falling back to single-threaded if possible, or aborting custom module use.";
-        // Depending on final design, could fallback to Clipper2 or error.
-        // For now, if multi-thread custom is requested, we indicate it's not supported.
-        // The actual single-threaded call below will proceed if useThreads was the *only* issue.
-    }
+    // A single pair has nothing to spread over threads; calculateNfpBatch runs many pairs in parallel.
+    Q_UNUSED(useThreads);
     if (isInside) {
-        qWarning() << "NfpGenerator::originalModuleNfp: 'isInside' NFP calculation is not supported by the current single-threaded CustomMinkowski::CalculateNfp wrapper. This call will compute A-around-B NFP.";
-        // To correctly handle 'isInside' with the original module's logic, the wrapper might need
-        // an 'isInside' flag, or a separate wrapped function if the core logic differs significantly.
-        // Current CustomMinkowski::CalculateNfp is for A-around-B.
-        // For now, we'll proceed, but the result will be for A-around-B, not A-inside-B.
+        // The original module only convolves (A around B); the JS getInnerNfp builds the inner NFP
+        // from outer ones the same way minkowskiNfpInside does.
+        return minkowskiNfpInside(partA_orbiting, partB_static);
     }
 
     qDebug() << "Using CustomMinkowski::CalculateNfp (refactored from original minkowski.cc)";
 
     // Convert InternalParts to CustomMinkowski::PolygonWithHoles.
     // The points within PolygonWithHoles are expected as doubles, scaling happens inside CalculateNfp.
-    CustomMinkowski::PolygonWithHoles mPartA = internalPartToMinkowskiPolygon(partA_orbiting, 1.0 /* scale applied inside wrapper */);
-    CustomMinkowski::PolygonWithHoles mPartB = internalPartToMinkowskiPolygon(partB_static, 1.0 /* scale applied inside wrapper */);
+    CustomMinkowski::PolygonWithHoles mPartA = internalPartToMinkowskiPolygon(partA_orbiting, this->scale_);
+    CustomMinkowski::PolygonWithHoles mPartB = internalPartToMinkowskiPolygon(partB_static, this->scale_);
     
     CustomMinkowski::NfpResultPolygons mResult;
-    // The fixed_scale_for_boost_poly is crucial. The original minkowski.cc calculated this dynamically.
-    // The refactored wrapper now takes it as an argument.
-    // We use this->scale_ which is config_.clipperScale. This might be very different from the dynamic
-    // scale used by the original module. This is a potential point of incompatibility or precision issues.
-    bool success = CustomMinkowski::CalculateNfp(mPartA, mPartB, mResult, this->scale_);
+    // Boost.Polygon works on int coordinates, so clipperScale (1e7) would overflow for anything larger
+    // than a few hundred units. Scale 0 lets CalculateNfp pick the largest safe scale for this pair.
+    // The module takes the static part first (JS convention): B (+) reflect(A), as minkowskiNfp.
+    bool success = CustomMinkowski::CalculateNfp(mPartB, mPartA, mResult, 0.0);
 
     if (!success) {
         qWarning() << "NfpGenerator::originalModuleNfp: CustomMinkowski::CalculateNfp reported failure or produced no NFP.";
-        return QList<QPolygonF>();
+        return Clipper2Lib::Paths64();
     }
     
     qDebug() << "CustomMinkowski::CalculateNfp returned" << mResult.size() << "NFP paths.";
-    // The minkowskiResultToQPolygonFs function expects results to be unscaled by the wrapper.
-    return minkowskiResultToQPolygonFs(mResult, this->scale_ /* not used if wrapper unscales */);
+    return minkowskiResultToPaths64(mResult, this->scale_);
 }
 
 
-QList<QPolygonF> NfpGenerator::calculateNfp(
+Clipper2Lib::Paths64 NfpGenerator::calculateNfp(
     const Core::InternalPart& partA, 
     const Core::InternalPart& partB,
-    bool useOriginalDeepNestModule,
+    NfpBackend backend,
     bool allowOriginalModuleMultithreading
 ) {
-    if (useOriginalDeepNestModule) {
+    QElapsedTimer timer;
+    timer.start();
+    Clipper2Lib::Paths64 nfp;
+    if (partA.isConvex && partB.isConvex && partA.holesPath64.empty() && partB.holesPath64.empty()) {
+        nfp = convexNfp(partA, partB);
+        if (!nfp.empty()) {
+            recordLatency(NfpBackend::Convex, NfpKind::Outer, timer.nsecsElapsed());
+            return nfp;
+        }
+    }
+    if (backend == NfpBackend::Decomposition) {
+        nfp = decompositionNfp(partA, partB);
+        if (!nfp.empty()) {
+            recordLatency(NfpBackend::Decomposition, NfpKind::Outer, timer.nsecsElapsed());
+            return nfp;
+        }
+        qDebug() << "NfpGenerator: No convex pieces for" << partA.id << "or" << partB.id << "(or holes) - using Clipper2.";
+        backend = NfpBackend::Clipper2;
+    }
+    if (backend == NfpBackend::Orbital) {
+        nfp = orbitalNfp(partA, partB, false);
+        if (!nfp.empty()) {
+            recordLatency(NfpBackend::Orbital, NfpKind::Outer, timer.nsecsElapsed());
+            return nfp;
+        }
+        qDebug() << "NfpGenerator: Orbit of" << partA.id << "around" << partB.id << "did not close - using Clipper2.";
+        backend = NfpBackend::Clipper2;
+    }
+    if (backend == NfpBackend::CustomMinkowski) {
         qDebug() << "NfpGenerator: Route to originalModuleNfp for NFP (A around B).";
-        return originalModuleNfp(partA, partB, false /*isInside=false*/, allowOriginalModuleMultithreading);
+        nfp = originalModuleNfp(partA, partB, false /*isInside=false*/, allowOriginalModuleMultithreading);
+        recordLatency(NfpBackend::CustomMinkowski, NfpKind::Outer, timer.nsecsElapsed());
     } else {
         qDebug() << "NfpGenerator: Route to minkowskiNfp (Clipper2) for NFP (A around B).";
-        return minkowskiNfp(partA, partB);
+        nfp = minkowskiNfp(partA, partB);
+        recordLatency(NfpBackend::Clipper2, NfpKind::Outer, timer.nsecsElapsed());
     }
+    return nfp;
 }
 
-QList<QPolygonF> NfpGenerator::calculateNfpInside(
+QVector<Clipper2Lib::Paths64> NfpGenerator::calculateNfpBatch(const QVector<NfpPair>& pairs, NfpBackend backend) {
+    QVector<Clipper2Lib::Paths64> results(pairs.size());
+    if (backend != NfpBackend::CustomMinkowski) {
+        for (int i = 0; i < pairs.size(); ++i) {
+            results[i] = calculateNfp(*pairs[i].partA, *pairs[i].partB, backend, false);
+        }
+        return results;
+    }
+
+    std::vector<CustomMinkowski::NfpTaskItem> tasks;
+    tasks.reserve(pairs.size());
+    for (int i = 0; i < pairs.size(); ++i) {
+        const Core::InternalPart& partA = *pairs[i].partA;
+        const Core::InternalPart& partB = *pairs[i].partB;
+        if (partA.isConvex && partB.isConvex && partA.holesPath64.empty() && partB.holesPath64.empty()) {
+            results[i] = calculateNfp(partA, partB, backend, false); // Convex kernel, no need for the pool
+            if (!results[i].empty()) continue;
+        }
+        // Static part first, see originalModuleNfp.
+        tasks.push_back({internalPartToMinkowskiPolygon(partB, scale_), internalPartToMinkowskiPolygon(partA, scale_), i});
+    }
+    if (tasks.empty()) {
+        return results;
+    }
+
+    QElapsedTimer timer;
+    timer.start();
+    std::vector<CustomMinkowski::NfpBatchResultItem> batchResults;
+    if (!CustomMinkowski::CalculateNfp_Batch_MultiThreaded(tasks, batchResults, 0.0 /*per-pair scale*/, 0)) {
+        qWarning() << "NfpGenerator::calculateNfpBatch: CustomMinkowski batch rejected" << tasks.size() << "tasks.";
+        return results;
+    }
+    // The pairs ran concurrently, so each one is accounted the batch's mean wall time.
+    const qint64 meanNanoseconds = timer.nsecsElapsed() / static_cast<qint64>(tasks.size());
+    for (const CustomMinkowski::NfpBatchResultItem& item : batchResults) {
+        if (item.success) {
+            results[item.taskId] = minkowskiResultToPaths64(item.nfp, scale_);
+        } else {
+            qWarning() << "NfpGenerator::calculateNfpBatch: CustomMinkowski failed for" << pairs[item.taskId].partA->id
+                       << "around" << pairs[item.taskId].partB->id << QString::fromStdString(item.error_message);
+        }
+        recordLatency(NfpBackend::CustomMinkowski, NfpKind::Outer, meanNanoseconds);
+    }
+    return results;
+}
+
+Clipper2Lib::Paths64 NfpGenerator::calculateNfpInside(
     const Core::InternalPart& partA_fitting,
     const Core::InternalPart& partB_container,
-    bool useOriginalDeepNestModule,
+    NfpBackend backend,
     bool allowOriginalModuleMultithreading
 ) {
-    if (useOriginalDeepNestModule) {
-        qWarning() << "NfpGenerator: Route to originalModuleNfp for NFP (A inside B). 'isInside' specific logic might not be fully supported by current custom wrapper.";
-        // The current originalModuleNfp will warn that 'isInside' is not truly handled.
-        return originalModuleNfp(partA_fitting, partB_container, true /*isInside=true*/, allowOriginalModuleMultithreading);
+    QElapsedTimer timer;
+    timer.start();
+    Clipper2Lib::Paths64 nfp;
+    // Sheets are nearly always rectangles: shrink by the part's bounds whichever backend is selected.
+    Clipper2Lib::Rect64 containerRect;
+    if (GeometryUtils::isAxisAlignedRectangle(partB_container.outerPath64, &containerRect)) {
+        nfp = GeometryUtils::rectangleInnerRegion(containerRect, partB_container.holesPath64, partRegion(partA_fitting));
+        recordLatency(NfpBackend::Rectangle, NfpKind::Inner, timer.nsecsElapsed());
+        return nfp;
+    }
+    if (backend == NfpBackend::Orbital) {
+        nfp = orbitalNfp(partA_fitting, partB_container, true);
+        if (!nfp.empty()) {
+            recordLatency(NfpBackend::Orbital, NfpKind::Inner, timer.nsecsElapsed());
+            return nfp;
+        }
+        qDebug() << "NfpGenerator: No inner orbit of" << partA_fitting.id << "in" << partB_container.id << "- using Clipper2.";
+        backend = NfpBackend::Clipper2;
+    }
+    if (backend == NfpBackend::CustomMinkowski) {
+        qDebug() << "NfpGenerator: Route to originalModuleNfp for NFP (A inside B).";
+        nfp = originalModuleNfp(partA_fitting, partB_container, true /*isInside=true*/, allowOriginalModuleMultithreading);
+        recordLatency(NfpBackend::CustomMinkowski, NfpKind::Inner, timer.nsecsElapsed());
     } else {
         qDebug() << "NfpGenerator: Route to minkowskiNfpInside (Clipper2) for NFP (A inside B).";
-        return minkowskiNfpInside(partA_fitting, partB_container);
+        nfp = minkowskiNfpInside(partA_fitting, partB_container);
+        recordLatency(NfpBackend::Clipper2, NfpKind::Inner, timer.nsecsElapsed());
     }
+    return nfp;
 }
 
 } // namespace Geometry
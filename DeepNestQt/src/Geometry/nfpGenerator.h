@@ -4,8 +4,10 @@
 #include "internalTypes.h" // For Core::InternalPart
 #include "Clipper2/clipper.h"       // From Clipper2 library (clipper.h is the main header)
 #include "minkowski_wrapper.h" // Added for CustomMinkowski
+#include "nfpStats.h"         // For Geometry::NfpStats
 #include <QList>
 #include <QPolygonF>
+#include <QVector>
 
 // Forward declaration from SvgNest.h if needed, or include a slim config header
 // For now, assume relevant config values (like clipperScale) are passed directly.
@@ -13,63 +15,93 @@
 
 namespace Geometry {
 
+// One orbiting/static pair of a calculateNfpBatch request (parts not owned).
+struct NfpPair {
+    const Core::InternalPart* partA; // Orbiting part
+    const Core::InternalPart* partB; // Static part
+};
+
 class NfpGenerator {
 public:
     // Constructor - takes scaling factor for Clipper library
     NfpGenerator(double clipperScale);
     ~NfpGenerator();
 
+    // Optional sink for per-backend computation latencies (not owned).
+    void setStats(NfpStats* stats) { stats_ = stats; }
+    // Orbital backend only: also search interlocking positions inside concavities (Configuration::exploreConcave).
+    void setExploreConcave(bool explore) { exploreConcave_ = explore; }
+
     // Calculates the No-Fit Polygon for partA (orbiting) around partB (static).
-    // Returns a list of polygons representing the NFP. Usually one, but could be multiple.
-    // 'useMinkowskiModule' is a placeholder for choosing between the original C++ module and Clipper2.
-    // 'threadCount' is for the original C++ module if it supports threading.
-    QList<QPolygonF> calculateNfp(
+    // Works on the parts' outerPath64/holesPath64 (see InternalPart::buildPath64) and returns the
+    // NFP in the same fixed-point coordinates. The result is a region: outer rings positive, holes
+    // negative. Holes are the positions where A sits inside a hole of B (or B inside a hole of A),
+    // so consumers test it with an even-odd fill, see GeometryUtils::minkowskiSumRegions.
+    // Pairs of convex parts (InternalPart::isConvex) take the linear convex kernel whichever backend is selected.
+    // 'backend' chooses between Clipper2, the original C++ module, the convex decomposition and the orbital port.
+    // 'allowOriginalModuleMultithreading' is for the original C++ module if it supports threading.
+    Clipper2Lib::Paths64 calculateNfp(
         const Core::InternalPart& partA, // Orbiting part
         const Core::InternalPart& partB, // Static part
-        bool useOriginalDeepNestModule,  // True to attempt using DeepNest's C++ NFP code
+        NfpBackend backend,
         bool allowOriginalModuleMultithreading // If true, and original module is used, allow it to use threads
     );
+
+    // Outer NFPs of several pairs at once; result i belongs to pairs[i].
+    // With the original C++ module the pairs run in one CustomMinkowski::CalculateNfp_Batch_MultiThreaded
+    // call on idle threads of the global QThreadPool; convex pairs and the other backends go through calculateNfp.
+    QVector<Clipper2Lib::Paths64> calculateNfpBatch(const QVector<NfpPair>& pairs, NfpBackend backend);
     
     // Calculates NFP for partA (orbiting) trying to fit INSIDE partB (static part's outer boundary, considering its holes).
-    // This is different from A around B.
-    QList<QPolygonF> calculateNfpInside(
+    // This is different from A around B. B's holes are holes of the result, i.e. forbidden positions.
+    // Axis-aligned rectangular containers take the analytic GeometryUtils::rectangleInnerRegion.
+    // Backends without an inner variant (decomposition, the original module) use Clipper2.
+    // The orbital backend falls back to Clipper2 when its orbit does not close.
+    Clipper2Lib::Paths64 calculateNfpInside(
         const Core::InternalPart& partA,
         const Core::InternalPart& partB, // The "container" part
-        bool useOriginalDeepNestModule,
+        NfpBackend backend,
         bool allowOriginalModuleMultithreading
     );
 
 
 private:
     double scale_; // Scale factor for Clipper operations
+    NfpStats* stats_ = nullptr;
+    bool exploreConcave_ = false;
 
-    // Helper to convert QPolygonF to Clipper2 PathsD
-    Clipper2Lib::PathD qPolygonFToPathD(const QPolygonF& polygon) const;
-    Clipper2Lib::PathsD qPolygonFToPathsD(const QPolygonF& polygon) const;
-    Clipper2Lib::PathsD qPolygonFsToPathsD(const QList<QPolygonF>& polygons) const;
-    // Helper to convert Clipper2 PathsD to QList<QPolygonF>
-    QList<QPolygonF> pathsDToQPolygonFs(const Clipper2Lib::PathsD& paths) const;
+    void recordLatency(NfpBackend backend, NfpKind kind, qint64 nanoseconds) {
+        if (stats_) stats_->latency(backend, kind).record(nanoseconds);
+    }
 
     // --- Methods for NFP using Clipper2 (Minkowski Sum) ---
     // NFP(A, B) where A orbits B (B is static)
-    // This is typically MinkowskiSum(B, Reflect(A, origin))
-    QList<QPolygonF> minkowskiNfp(const Core::InternalPart& partA, const Core::InternalPart& partB);
-
-    // NFP for A fitting INSIDE B.
-    // This is more complex. For a convex B, it could be MinkowskiDiff(B_hole, A) for each hole of B,
-    // and MinkowskiSum(Shrink(B_boundary, A_radius), Reflect(A_hole_shape, origin))
-    // Or, B_boundary - MinkowskiSum(A_boundary, Reflect(hole_in_A)) and union with MinkowskiSum(hole_in_B, Reflect(A_boundary)).
-    // DeepNest's original JS implementation has specific logic for this.
-    // For now, a placeholder or simplified version.
-    // A common approach for "inner NFP" is to consider the boundaries.
-    // For placing A inside B's boundary: NFP = B_boundary - Reflect(A_boundary, A_reference_point)
-    // where '-' is Minkowski Difference.
-    // And for each hole H_b in B, NFP_Hb = Reflect(A_boundary, A_reference_point) + H_b (Minkowski Sum)
-    QList<QPolygonF> minkowskiNfpInside(const Core::InternalPart& partA, const Core::InternalPart& partB);
+    // MinkowskiSum(B, Reflect(A, origin)) of the two regions including their holes
+    Clipper2Lib::Paths64 minkowskiNfp(const Core::InternalPart& partA, const Core::InternalPart& partB);
+
+    // Same NFP for two convex parts in O(n+m), see GeometryUtils::minkowskiSumConvex.
+    // Empty if a boundary turns out degenerate, in which case the general backend runs.
+    Clipper2Lib::Paths64 convexNfp(const Core::InternalPart& partA, const Core::InternalPart& partB);
+
+    // NFP as the union of the convex sums of every pair of convex pieces (InternalPart::convexPieces),
+    // merged by a single Clipper2 Union. Empty if either part has no pieces or has holes.
+    Clipper2Lib::Paths64 decompositionNfp(const Core::InternalPart& partA, const Core::InternalPart& partB);
+
+    // NFP traced by sliding A around (or inside) B's outer boundary, see OrbitalNfp. Outer results are
+    // oriented like Clipper2's (outer loop positive, interlocking loops negative), inner loops positive.
+    // Outer NFPs gain the inner orbits of A in each of B's holes as further holes; inner NFPs lose
+    // the positions overlapping the container's holes. Empty if the orbit failed, if an outer loop is
+    // smaller than B (the JS sanity check) or, for outer NFPs, if A has holes.
+    Clipper2Lib::Paths64 orbitalNfp(const Core::InternalPart& partA, const Core::InternalPart& partB, bool inside);
+
+    // NFP for A fitting INSIDE B: the positions where A lies within B's material, see
+    // GeometryUtils::minkowskiInnerRegion. B's holes come out as holes of the region.
+    Clipper2Lib::Paths64 minkowskiNfpInside(const Core::InternalPart& partA, const Core::InternalPart& partB);
 
 
     // --- Placeholders for original DeepNest NFP module integration ---
-    QList<QPolygonF> originalModuleNfp(const Core::InternalPart& partA, const Core::InternalPart& partB, bool isInside, bool useThreads);
+    // Boost.Polygon works on its own scaled coordinates; the result is converted back to scale_.
+    Clipper2Lib::Paths64 originalModuleNfp(const Core::InternalPart& partA, const Core::InternalPart& partB, bool isInside, bool useThreads);
 };
 
 } // namespace Geometry
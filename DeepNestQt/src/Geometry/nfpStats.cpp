@@ -0,0 +1,155 @@
+#include "nfpStats.h"
+#include <QJsonArray>
+#include <QtGlobal>
+#include <cmath>
+
+namespace Geometry {
+
+const char* nfpBackendName(NfpBackend backend) {
+    switch (backend) {
+    case NfpBackend::Clipper2:        return "clipper2";
+    case NfpBackend::CustomMinkowski: return "customMinkowski";
+    case NfpBackend::Convex:          return "convex";
+    case NfpBackend::Decomposition:   return "decomposition";
+    case NfpBackend::Orbital:         return "orbital";
+    case NfpBackend::Rectangle:       return "rectangle";
+    default:                          return "unknown";
+    }
+}
+
+NfpBackend nfpBackendFromName(const QString& name, NfpBackend fallback) {
+    for (int b = 0; b < static_cast<int>(NfpBackend::BackendCount); ++b) {
+        if (name == QLatin1String(nfpBackendName(static_cast<NfpBackend>(b)))) {
+            return static_cast<NfpBackend>(b);
+        }
+    }
+    return fallback;
+}
+
+const char* nfpKindName(NfpKind kind) {
+    return kind == NfpKind::Inner ? "inner" : "outer";
+}
+
+// --- LatencyHistogram ---
+
+LatencyHistogram::LatencyHistogram() {
+    reset();
+}
+
+void LatencyHistogram::record(qint64 nanoseconds) {
+    if (nanoseconds < 0) nanoseconds = 0;
+    const quint64 ns = static_cast<quint64>(nanoseconds);
+    quint64 microseconds = ns / 1000;
+    int bucket = 0;
+    while (microseconds > 0 && bucket < BucketCount - 1) {
+        microseconds >>= 1;
+        ++bucket;
+    }
+    buckets_[bucket].fetchAndAddRelaxed(1);
+    count_.fetchAndAddRelaxed(1);
+    totalNanoseconds_.fetchAndAddRelaxed(ns);
+    quint64 currentMax = maxNanoseconds_.loadRelaxed();
+    while (ns > currentMax && !maxNanoseconds_.testAndSetRelaxed(currentMax, ns, currentMax)) {
+    }
+}
+
+void LatencyHistogram::reset() {
+    for (int i = 0; i < BucketCount; ++i) {
+        buckets_[i].storeRelaxed(0);
+    }
+    count_.storeRelaxed(0);
+    totalNanoseconds_.storeRelaxed(0);
+    maxNanoseconds_.storeRelaxed(0);
+}
+
+double LatencyHistogram::percentileMicroseconds(double fraction) const {
+    const quint64 total = count();
+    if (total == 0) return 0.0;
+    // Nearest rank: the smallest sample with at least 'fraction' of all samples at or below it.
+    const quint64 rank = qMax<quint64>(1, static_cast<quint64>(std::ceil(fraction * static_cast<double>(total))));
+    quint64 seen = 0;
+    for (int i = 0; i < BucketCount; ++i) {
+        seen += buckets_[i].loadRelaxed();
+        if (seen >= rank) {
+            return static_cast<double>(1ULL << i); // Upper bound of bucket i
+        }
+    }
+    return static_cast<double>(1ULL << (BucketCount - 1));
+}
+
+QJsonObject LatencyHistogram::toJson() const {
+    const quint64 samples = count();
+    const double totalUs = static_cast<double>(totalNanoseconds_.loadRelaxed()) / 1000.0;
+    QJsonObject json;
+    json["count"] = static_cast<double>(samples);
+    json["totalMs"] = totalUs / 1000.0;
+    json["meanUs"] = samples > 0 ? totalUs / static_cast<double>(samples) : 0.0;
+    json["maxUs"] = static_cast<double>(maxNanoseconds_.loadRelaxed()) / 1000.0;
+    json["p50Us"] = percentileMicroseconds(0.50);
+    json["p90Us"] = percentileMicroseconds(0.90);
+    json["p99Us"] = percentileMicroseconds(0.99);
+    // Trailing empty buckets are dropped; entry i counts samples below 2^i us.
+    int last = BucketCount - 1;
+    while (last >= 0 && buckets_[last].loadRelaxed() == 0) --last;
+    QJsonArray buckets;
+    for (int i = 0; i <= last; ++i) {
+        buckets.append(static_cast<double>(buckets_[i].loadRelaxed()));
+    }
+    json["bucketsLog2Us"] = buckets;
+    return json;
+}
+
+// --- NfpStats ---
+
+NfpStats::NfpStats() {
+    reset();
+}
+
+void NfpStats::reset() {
+    for (int k = 0; k < KindCount; ++k) {
+        hits_[k].storeRelaxed(0);
+        misses_[k].storeRelaxed(0);
+        waits_[k].storeRelaxed(0);
+    }
+    evictions_.storeRelaxed(0);
+    evictedBytes_.storeRelaxed(0);
+    for (int b = 0; b < BackendCount; ++b) {
+        for (int k = 0; k < KindCount; ++k) {
+            latency_[b][k].reset();
+        }
+    }
+}
+
+QJsonObject NfpStats::toJson() const {
+    QJsonObject json;
+    for (int k = 0; k < KindCount; ++k) {
+        const quint64 hitCount = hits_[k].loadRelaxed();
+        const quint64 missCount = misses_[k].loadRelaxed();
+        QJsonObject kindJson;
+        kindJson["hits"] = static_cast<double>(hitCount);
+        kindJson["misses"] = static_cast<double>(missCount);
+        kindJson["singleFlightWaits"] = static_cast<double>(waits_[k].loadRelaxed());
+        kindJson["hitRate"] = hitCount + missCount > 0
+            ? static_cast<double>(hitCount) / static_cast<double>(hitCount + missCount) : 0.0;
+        json[nfpKindName(static_cast<NfpKind>(k))] = kindJson;
+    }
+    json["evictions"] = static_cast<double>(evictions_.loadRelaxed());
+    json["evictedBytes"] = static_cast<double>(evictedBytes_.loadRelaxed());
+
+    QJsonObject latencyJson;
+    for (int b = 0; b < BackendCount; ++b) {
+        QJsonObject backendJson;
+        for (int k = 0; k < KindCount; ++k) {
+            if (latency_[b][k].count() > 0) {
+                backendJson[nfpKindName(static_cast<NfpKind>(k))] = latency_[b][k].toJson();
+            }
+        }
+        if (!backendJson.isEmpty()) {
+            latencyJson[nfpBackendName(static_cast<NfpBackend>(b))] = backendJson;
+        }
+    }
+    json["latency"] = latencyJson;
+    return json;
+}
+
+} // namespace Geometry
@@ -0,0 +1,100 @@
+#ifndef NFPSTATS_H
+#define NFPSTATS_H
+
+#include <QAtomicInteger>
+#include <QJsonObject>
+#include <QString>
+
+namespace Geometry {
+
+// Implementation that produced an NFP, for per-backend latency statistics.
+enum class NfpBackend : int {
+    Clipper2 = 0,        // Clipper2 Minkowski sum/difference
+    CustomMinkowski,     // Boost.Polygon based port of DeepNest's minkowski.cc
+    Convex,              // Linear edge merge for convex pairs (GeometryUtils::minkowskiSumConvex)
+    Decomposition,       // Union of the convex sums of the parts' convex pieces
+    Orbital,             // Sliding (orbiting) NFP ported from DeepNest's JS noFitPolygon (OrbitalNfp)
+    Rectangle,           // Analytic inner NFP of rectangular containers (GeometryUtils::rectangleInnerRegion)
+    BackendCount
+};
+
+// Outer NFPs (part around part) versus inner NFPs (part inside sheet or container).
+enum class NfpKind : int {
+    Outer = 0,
+    Inner,
+    KindCount
+};
+
+const char* nfpBackendName(NfpBackend backend);
+// Inverse of nfpBackendName, for Configuration::nfpBackend; 'fallback' for unknown names.
+NfpBackend nfpBackendFromName(const QString& name, NfpBackend fallback);
+const char* nfpKindName(NfpKind kind);
+
+// Lock-free latency histogram with power-of-two microsecond buckets:
+// bucket 0 holds samples below 1 us, bucket i samples in [2^(i-1), 2^i) us.
+class LatencyHistogram {
+public:
+    static const int BucketCount = 32;
+
+    LatencyHistogram();
+
+    void record(qint64 nanoseconds);
+    quint64 count() const { return count_.loadRelaxed(); }
+    void reset();
+
+    // Count, total/mean/max times and percentile estimates (bucket upper bounds), plus the raw buckets.
+    QJsonObject toJson() const;
+
+private:
+    QAtomicInteger<quint64> buckets_[BucketCount];
+    QAtomicInteger<quint64> count_;
+    QAtomicInteger<quint64> totalNanoseconds_;
+    QAtomicInteger<quint64> maxNanoseconds_;
+
+    double percentileMicroseconds(double fraction) const;
+};
+
+// Counters of one NfpCache and latency histograms of the NFP computations feeding it.
+// All updates are relaxed atomic increments, cheap enough to stay enabled in production.
+class NfpStats {
+public:
+    NfpStats();
+
+    void recordHit(NfpKind kind) { hits_[index(kind)].fetchAndAddRelaxed(1); }
+    void recordMiss(NfpKind kind) { misses_[index(kind)].fetchAndAddRelaxed(1); }
+    void recordWait(NfpKind kind) { waits_[index(kind)].fetchAndAddRelaxed(1); }
+    void recordEviction(qint64 bytes) {
+        evictions_.fetchAndAddRelaxed(1);
+        evictedBytes_.fetchAndAddRelaxed(static_cast<quint64>(bytes));
+    }
+
+    LatencyHistogram& latency(NfpBackend backend, NfpKind kind) {
+        return latency_[static_cast<int>(backend)][index(kind)];
+    }
+
+    quint64 hits(NfpKind kind) const { return hits_[index(kind)].loadRelaxed(); }
+    quint64 misses(NfpKind kind) const { return misses_[index(kind)].loadRelaxed(); }
+    quint64 waits(NfpKind kind) const { return waits_[index(kind)].loadRelaxed(); }
+    quint64 evictions() const { return evictions_.loadRelaxed(); }
+
+    void reset();
+
+    // {"outer": {hits, misses, waits, hitRate}, "inner": {...}, "evictions", "evictedBytes",
+    //  "latency": {backend: {kind: histogram}}}. Backends without samples are omitted.
+    QJsonObject toJson() const;
+
+private:
+    static const int KindCount = static_cast<int>(NfpKind::KindCount);
+    static const int BackendCount = static_cast<int>(NfpBackend::BackendCount);
+    static int index(NfpKind kind) { return static_cast<int>(kind); }
+
+    QAtomicInteger<quint64> hits_[KindCount];
+    QAtomicInteger<quint64> misses_[KindCount];
+    QAtomicInteger<quint64> waits_[KindCount];
+    QAtomicInteger<quint64> evictions_;
+    QAtomicInteger<quint64> evictedBytes_;
+    LatencyHistogram latency_[BackendCount][KindCount];
+};
+
+} // namespace Geometry
+#endif // NFPSTATS_H
@@ -0,0 +1,673 @@
+#include "orbitalNfp.h"
+#include <algorithm>
+#include <cmath>
+#include <optional>
+#include <vector>
+
+namespace Geometry {
+
+namespace {
+
+using Clipper2Lib::PathD;
+using Clipper2Lib::PathsD;
+using Clipper2Lib::PointD;
+
+// Floating point comparison tolerance, as in geometryutil.js
+const double TOL = 1e-9;
+
+bool almostEqual(double a, double b, double tolerance = TOL) {
+    return std::abs(a - b) < tolerance;
+}
+
+bool almostEqualPoints(const PointD& a, const PointD& b) {
+    return almostEqual(a.x, b.x) && almostEqual(a.y, b.y);
+}
+
+PointD offsetPoint(const PointD& p, const PointD& offset) {
+    return PointD(p.x + offset.x, p.y + offset.y);
+}
+
+PointD normalizeVector(const PointD& v) {
+    if (almostEqual(v.x * v.x + v.y * v.y, 1)) {
+        return v; // Already a unit vector
+    }
+    const double inverse = 1.0 / std::sqrt(v.x * v.x + v.y * v.y);
+    return PointD(v.x * inverse, v.y * inverse);
+}
+
+// True if p lies on the segment AB, but not at either endpoint.
+bool onSegment(const PointD& A, const PointD& B, const PointD& p, double tolerance = TOL) {
+    // Vertical line
+    if (almostEqual(A.x, B.x, tolerance) && almostEqual(p.x, A.x, tolerance)) {
+        return !almostEqual(p.y, B.y, tolerance) && !almostEqual(p.y, A.y, tolerance) &&
+               p.y < std::max(B.y, A.y) && p.y > std::min(B.y, A.y);
+    }
+
+    // Horizontal line
+    if (almostEqual(A.y, B.y, tolerance) && almostEqual(p.y, A.y, tolerance)) {
+        return !almostEqual(p.x, B.x, tolerance) && !almostEqual(p.x, A.x, tolerance) &&
+               p.x < std::max(B.x, A.x) && p.x > std::min(B.x, A.x);
+    }
+
+    // Range check
+    if ((p.x < A.x && p.x < B.x) || (p.x > A.x && p.x > B.x) || (p.y < A.y && p.y < B.y) || (p.y > A.y && p.y > B.y)) {
+        return false;
+    }
+
+    // Exclude end points
+    if ((almostEqual(p.x, A.x, tolerance) && almostEqual(p.y, A.y, tolerance)) ||
+        (almostEqual(p.x, B.x, tolerance) && almostEqual(p.y, B.y, tolerance))) {
+        return false;
+    }
+
+    const double cross = (p.y - A.y) * (B.x - A.x) - (p.x - A.x) * (B.y - A.y);
+    if (std::abs(cross) > tolerance) {
+        return false;
+    }
+
+    const double dot = (p.x - A.x) * (B.x - A.x) + (p.y - A.y) * (B.y - A.y);
+    if (dot < 0 || almostEqual(dot, 0, tolerance)) {
+        return false;
+    }
+
+    const double len2 = (B.x - A.x) * (B.x - A.x) + (B.y - A.y) * (B.y - A.y);
+    if (dot > len2 || almostEqual(dot, len2, tolerance)) {
+        return false;
+    }
+    return true;
+}
+
+// True if the segments AB and EF intersect (coincident endpoints do not count).
+bool segmentsIntersect(const PointD& A, const PointD& B, const PointD& E, const PointD& F) {
+    const double a1 = B.y - A.y;
+    const double b1 = A.x - B.x;
+    const double c1 = B.x * A.y - A.x * B.y;
+    const double a2 = F.y - E.y;
+    const double b2 = E.x - F.x;
+    const double c2 = F.x * E.y - E.x * F.y;
+
+    const double denom = a1 * b2 - a2 * b1;
+    const double x = (b1 * c2 - b2 * c1) / denom;
+    const double y = (a2 * c1 - a1 * c2) / denom;
+    if (!std::isfinite(x) || !std::isfinite(y)) {
+        return false;
+    }
+
+    if (std::abs(A.x - B.x) > TOL && ((A.x < B.x) ? x < A.x || x > B.x : x > A.x || x < B.x)) return false;
+    if (std::abs(A.y - B.y) > TOL && ((A.y < B.y) ? y < A.y || y > B.y : y > A.y || y < B.y)) return false;
+    if (std::abs(E.x - F.x) > TOL && ((E.x < F.x) ? x < E.x || x > F.x : x > E.x || x < F.x)) return false;
+    if (std::abs(E.y - F.y) > TOL && ((E.y < F.y) ? y < E.y || y > F.y : y > E.y || y < F.y)) return false;
+    return true;
+}
+
+// Inside/outside, or no value if the point is exactly on a vertex or an edge.
+std::optional<bool> pointInPolygon(const PointD& point, const PathD& polygon, const PointD& offset) {
+    if (polygon.size() < 3) {
+        return std::nullopt;
+    }
+    bool inside = false;
+    for (size_t i = 0, j = polygon.size() - 1; i < polygon.size(); j = i++) {
+        const PointD pi = offsetPoint(polygon[i], offset);
+        const PointD pj = offsetPoint(polygon[j], offset);
+
+        if (almostEqual(pi.x, point.x) && almostEqual(pi.y, point.y)) {
+            return std::nullopt; // On a vertex
+        }
+        if (onSegment(pi, pj, point)) {
+            return std::nullopt; // Exactly on the segment
+        }
+        if (almostEqual(pi.x, pj.x) && almostEqual(pi.y, pj.y)) {
+            continue; // Ignore very small lines
+        }
+        const bool crosses = ((pi.y > point.y) != (pj.y > point.y)) &&
+                             (point.x < (pj.x - pi.x) * (point.y - pi.y) / (pj.y - pi.y) + pi.x);
+        if (crosses) inside = !inside;
+    }
+    return inside;
+}
+
+bool isTrue(const std::optional<bool>& value) { return value.has_value() && *value; }
+bool isFalse(const std::optional<bool>& value) { return value.has_value() && !*value; }
+
+// True if the closed polygons A and B (last vertex repeating the first) properly intersect.
+// A vertex touching an edge only counts when its neighbours lie on opposite sides.
+bool polygonsIntersect(const PathD& A, const PointD& offsetA, const PathD& B, const PointD& offsetB) {
+    const int sizeA = static_cast<int>(A.size());
+    const int sizeB = static_cast<int>(B.size());
+    for (int i = 0; i < sizeA - 1; ++i) {
+        for (int j = 0; j < sizeB - 1; ++j) {
+            const PointD a1 = offsetPoint(A[i], offsetA);
+            const PointD a2 = offsetPoint(A[i + 1], offsetA);
+            const PointD b1 = offsetPoint(B[j], offsetB);
+            const PointD b2 = offsetPoint(B[j + 1], offsetB);
+
+            int prevB = (j == 0) ? sizeB - 1 : j - 1;
+            int prevA = (i == 0) ? sizeA - 1 : i - 1;
+            int nextB = (j + 1 == sizeB - 1) ? 0 : j + 2;
+            int nextA = (i + 1 == sizeA - 1) ? 0 : i + 2;
+
+            // Go even further back/forward if we happen to hit on a loop end point
+            if (almostEqualPoints(B[prevB], B[j])) prevB = (prevB == 0) ? sizeB - 1 : prevB - 1;
+            if (almostEqualPoints(A[prevA], A[i])) prevA = (prevA == 0) ? sizeA - 1 : prevA - 1;
+            if (almostEqualPoints(B[nextB], B[j + 1])) nextB = (nextB == sizeB - 1) ? 0 : nextB + 1;
+            if (almostEqualPoints(A[nextA], A[i + 1])) nextA = (nextA == sizeA - 1) ? 0 : nextA + 1;
+
+            const PointD a0 = offsetPoint(A[prevA], offsetA);
+            const PointD b0 = offsetPoint(B[prevB], offsetB);
+            const PointD a3 = offsetPoint(A[nextA], offsetA);
+            const PointD b3 = offsetPoint(B[nextB], offsetB);
+
+            // A point on a segment may or may not be a crossing; decide via the neighbouring points.
+            auto crossesAt = [](const std::optional<bool>& before, const std::optional<bool>& after) {
+                return (isTrue(before) && isFalse(after)) || (isFalse(before) && isTrue(after));
+            };
+            if (onSegment(a1, a2, b1) || almostEqualPoints(a1, b1)) {
+                if (crossesAt(pointInPolygon(b0, A, offsetA), pointInPolygon(b2, A, offsetA))) return true;
+                continue;
+            }
+            if (onSegment(a1, a2, b2) || almostEqualPoints(a2, b2)) {
+                if (crossesAt(pointInPolygon(b1, A, offsetA), pointInPolygon(b3, A, offsetA))) return true;
+                continue;
+            }
+            if (onSegment(b1, b2, a1) || almostEqualPoints(a1, b2)) {
+                if (crossesAt(pointInPolygon(a0, B, offsetB), pointInPolygon(a2, B, offsetB))) return true;
+                continue;
+            }
+            if (onSegment(b1, b2, a2) || almostEqualPoints(a2, b1)) {
+                if (crossesAt(pointInPolygon(a1, B, offsetB), pointInPolygon(a3, B, offsetB))) return true;
+                continue;
+            }
+            if (segmentsIntersect(b1, b2, a1, a2)) {
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+// Distance from p to the segment s1 s2 along 'normal'; no value if p does not hit the segment.
+std::optional<double> pointDistance(const PointD& p, const PointD& s1, const PointD& s2, PointD normal,
+                                    bool infinite = false) {
+    normal = normalizeVector(normal);
+    const PointD dir(normal.y, -normal.x);
+
+    const double pdot = p.x * dir.x + p.y * dir.y;
+    const double s1dot = s1.x * dir.x + s1.y * dir.y;
+    const double s2dot = s2.x * dir.x + s2.y * dir.y;
+
+    const double pdotnorm = p.x * normal.x + p.y * normal.y;
+    const double s1dotnorm = s1.x * normal.x + s1.y * normal.y;
+    const double s2dotnorm = s2.x * normal.x + s2.y * normal.y;
+
+    if (!infinite) {
+        if (((pdot < s1dot || almostEqual(pdot, s1dot)) && (pdot < s2dot || almostEqual(pdot, s2dot))) ||
+            ((pdot > s1dot || almostEqual(pdot, s1dot)) && (pdot > s2dot || almostEqual(pdot, s2dot)))) {
+            return std::nullopt; // Does not collide with the segment, or lies directly on the vertex
+        }
+        if ((almostEqual(pdot, s1dot) && almostEqual(pdot, s2dot)) && (pdotnorm > s1dotnorm && pdotnorm > s2dotnorm)) {
+            return std::min(pdotnorm - s1dotnorm, pdotnorm - s2dotnorm);
+        }
+        if ((almostEqual(pdot, s1dot) && almostEqual(pdot, s2dot)) && (pdotnorm < s1dotnorm && pdotnorm < s2dotnorm)) {
+            return -std::min(s1dotnorm - pdotnorm, s2dotnorm - pdotnorm);
+        }
+    }
+    return -(pdotnorm - s1dotnorm + (s1dotnorm - s2dotnorm) * (s1dot - pdot) / (s1dot - s2dot));
+}
+
+// How far segment AB can move along 'direction' (a unit vector) before it hits segment EF.
+std::optional<double> segmentDistance(const PointD& A, const PointD& B, const PointD& E, const PointD& F,
+                                      const PointD& direction) {
+    const PointD normal(direction.y, -direction.x);
+    const PointD reverse(-direction.x, -direction.y);
+
+    const double dotA = A.x * normal.x + A.y * normal.y;
+    const double dotB = B.x * normal.x + B.y * normal.y;
+    const double dotE = E.x * normal.x + E.y * normal.y;
+    const double dotF = F.x * normal.x + F.y * normal.y;
+
+    const double crossA = A.x * direction.x + A.y * direction.y;
+    const double crossB = B.x * direction.x + B.y * direction.y;
+    const double crossE = E.x * direction.x + E.y * direction.y;
+    const double crossF = F.x * direction.x + F.y * direction.y;
+
+    const double ABmin = std::min(dotA, dotB);
+    const double ABmax = std::max(dotA, dotB);
+    const double EFmax = std::max(dotE, dotF);
+    const double EFmin = std::min(dotE, dotF);
+
+    // Segments that will merely touch at one point
+    if (almostEqual(ABmax, EFmin) || almostEqual(ABmin, EFmax)) {
+        return std::nullopt;
+    }
+    // Segments miss each other completely
+    if (ABmax < EFmin || ABmin > EFmax) {
+        return std::nullopt;
+    }
+
+    double overlap;
+    if ((ABmax > EFmax && ABmin < EFmin) || (EFmax > ABmax && EFmin < ABmin)) {
+        overlap = 1;
+    } else {
+        const double minMax = std::min(ABmax, EFmax);
+        const double maxMin = std::max(ABmin, EFmin);
+        const double maxMax = std::max(ABmax, EFmax);
+        const double minMin = std::min(ABmin, EFmin);
+        overlap = (minMax - maxMin) / (maxMax - minMin);
+    }
+
+    const double crossABE = (E.y - A.y) * (B.x - A.x) - (E.x - A.x) * (B.y - A.y);
+    const double crossABF = (F.y - A.y) * (B.x - A.x) - (F.x - A.x) * (B.y - A.y);
+
+    // Lines are collinear
+    if (almostEqual(crossABE, 0) && almostEqual(crossABF, 0)) {
+        PointD ABnorm(B.y - A.y, A.x - B.x);
+        PointD EFnorm(F.y - E.y, E.x - F.x);
+        const double ABnormLength = std::sqrt(ABnorm.x * ABnorm.x + ABnorm.y * ABnorm.y);
+        ABnorm.x /= ABnormLength;
+        ABnorm.y /= ABnormLength;
+        const double EFnormLength = std::sqrt(EFnorm.x * EFnorm.x + EFnorm.y * EFnorm.y);
+        EFnorm.x /= EFnormLength;
+        EFnorm.y /= EFnormLength;
+
+        // Segment normals must point in opposite directions
+        if (std::abs(ABnorm.y * EFnorm.x - ABnorm.x * EFnorm.y) < TOL && ABnorm.y * EFnorm.y + ABnorm.x * EFnorm.x < 0) {
+            // Normal of AB must point in the same direction as the given direction vector
+            const double normdot = ABnorm.y * direction.y + ABnorm.x * direction.x;
+            if (almostEqual(normdot, 0)) {
+                return std::nullopt; // The segments merely slide along each other
+            }
+            if (normdot < 0) {
+                return 0.0;
+            }
+        }
+        return std::nullopt;
+    }
+
+    std::vector<double> distances;
+
+    // A vertex that currently touches the other segment but moves away from it does not limit the slide.
+    auto touchingButLeaving = [&](const std::optional<double>& d, const PointD& other, const PointD& s1,
+                                  const PointD& s2, const PointD& along) {
+        if (!d || !almostEqual(*d, 0)) return false;
+        const std::optional<double> dOther = pointDistance(other, s1, s2, along, true);
+        return *dOther < 0 || almostEqual(*dOther * overlap, 0);
+    };
+
+    // Coincident points
+    if (almostEqual(dotA, dotE)) {
+        distances.push_back(crossA - crossE);
+    } else if (almostEqual(dotA, dotF)) {
+        distances.push_back(crossA - crossF);
+    } else if (dotA > EFmin && dotA < EFmax) {
+        const std::optional<double> d = pointDistance(A, E, F, reverse);
+        if (d && !touchingButLeaving(d, B, E, F, reverse)) distances.push_back(*d);
+    }
+
+    if (almostEqual(dotB, dotE)) {
+        distances.push_back(crossB - crossE);
+    } else if (almostEqual(dotB, dotF)) {
+        distances.push_back(crossB - crossF);
+    } else if (dotB > EFmin && dotB < EFmax) {
+        const std::optional<double> d = pointDistance(B, E, F, reverse);
+        if (d && !touchingButLeaving(d, A, E, F, reverse)) distances.push_back(*d);
+    }
+
+    if (dotE > ABmin && dotE < ABmax) {
+        const std::optional<double> d = pointDistance(E, A, B, direction);
+        if (d && !touchingButLeaving(d, F, A, B, direction)) distances.push_back(*d);
+    }
+
+    if (dotF > ABmin && dotF < ABmax) {
+        const std::optional<double> d = pointDistance(F, A, B, direction);
+        if (d && !touchingButLeaving(d, E, A, B, direction)) distances.push_back(*d);
+    }
+
+    if (distances.empty()) {
+        return std::nullopt;
+    }
+    return *std::min_element(distances.begin(), distances.end());
+}
+
+PathD closedCopy(const PathD& polygon) {
+    PathD closed = polygon;
+    closed.push_back(polygon.front());
+    return closed;
+}
+
+// How far B can slide along 'direction' before it hits A.
+std::optional<double> polygonSlideDistance(const PathD& A, const PathD& B, const PointD& offsetB,
+                                           const PointD& direction, bool ignoreNegative) {
+    const PathD edgeA = closedCopy(A);
+    const PathD edgeB = closedCopy(B);
+    const PointD dir = normalizeVector(direction);
+
+    std::optional<double> distance;
+    for (size_t i = 0; i + 1 < edgeB.size(); ++i) {
+        for (size_t j = 0; j + 1 < edgeA.size(); ++j) {
+            const PointD& A1 = edgeA[j];
+            const PointD& A2 = edgeA[j + 1];
+            const PointD B1 = offsetPoint(edgeB[i], offsetB);
+            const PointD B2 = offsetPoint(edgeB[i + 1], offsetB);
+
+            if (almostEqualPoints(A1, A2) || almostEqualPoints(B1, B2)) {
+                continue; // Ignore extremely small lines
+            }
+
+            const std::optional<double> d = segmentDistance(A1, A2, B1, B2, dir);
+            if (d && (!distance || *d < *distance)) {
+                if (!ignoreNegative || *d > 0 || almostEqual(*d, 0)) {
+                    distance = d;
+                }
+            }
+        }
+    }
+    return distance;
+}
+
+// Projects each point of B onto A along 'direction' and returns the largest of the shortest projections.
+std::optional<double> polygonProjectionDistance(const PathD& A, const PointD& offsetA, const PathD& B,
+                                                const PointD& offsetB, const PointD& direction) {
+    const PathD edgeA = closedCopy(A);
+    const PathD edgeB = closedCopy(B);
+
+    std::optional<double> distance;
+    for (size_t i = 0; i < edgeB.size(); ++i) {
+        std::optional<double> minProjection;
+        const PointD p = offsetPoint(edgeB[i], offsetB);
+        for (size_t j = 0; j + 1 < edgeA.size(); ++j) {
+            const PointD s1 = offsetPoint(edgeA[j], offsetA);
+            const PointD s2 = offsetPoint(edgeA[j + 1], offsetA);
+
+            if (std::abs((s2.y - s1.y) * direction.x - (s2.x - s1.x) * direction.y) < TOL) {
+                continue;
+            }
+
+            // Project point, ignore edge boundaries
+            const std::optional<double> d = pointDistance(p, s1, s2, direction);
+            if (d && (!minProjection || *d < *minProjection)) {
+                minProjection = d;
+            }
+        }
+        if (minProjection && (!distance || *minProjection > *distance)) {
+            distance = minProjection;
+        }
+    }
+    return distance;
+}
+
+// True if the reference position already is a vertex of one of the loops found so far.
+bool inNfp(const PointD& p, const PathsD& nfps) {
+    for (const PathD& nfp : nfps) {
+        for (const PointD& q : nfp) {
+            if (almostEqualPoints(p, q)) return true;
+        }
+    }
+    return false;
+}
+
+// Searches for an offset of B at which A and B touch without overlapping (B inside A if 'inside'),
+// skipping A vertices that were already visited ('marked') and positions on the loops found so far.
+std::optional<PointD> searchStartPoint(const PathD& A, const PathD& B, bool inside, const PathsD& nfps,
+                                       std::vector<bool>& marked) {
+    const PathD closedA = closedCopy(A);
+    const PathD closedB = closedCopy(B);
+    const PointD noOffset(0, 0);
+
+    auto bIsInside = [&](const PointD& offset, std::optional<bool> previous) {
+        for (const PointD& vertex : closedB) {
+            const std::optional<bool> inPolygon = pointInPolygon(offsetPoint(vertex, offset), closedA, noOffset);
+            if (inPolygon) return inPolygon;
+        }
+        return previous;
+    };
+    auto isStartPoint = [&](const PointD& offset, bool bInside) {
+        return bInside == inside && !polygonsIntersect(closedA, noOffset, closedB, offset) &&
+               !inNfp(offsetPoint(B.front(), offset), nfps);
+    };
+
+    for (size_t i = 0; i + 1 < closedA.size(); ++i) {
+        if (marked[i]) continue;
+        marked[i] = true;
+        for (size_t j = 0; j < closedB.size(); ++j) {
+            PointD offset(closedA[i].x - closedB[j].x, closedA[i].y - closedB[j].y);
+
+            std::optional<bool> bInside = bIsInside(offset, std::nullopt);
+            if (!bInside) {
+                return std::nullopt; // A and B are the same
+            }
+            if (isStartPoint(offset, *bInside)) {
+                return offset;
+            }
+
+            // Slide B along the edge
+            double vx = closedA[i + 1].x - closedA[i].x;
+            double vy = closedA[i + 1].y - closedA[i].y;
+
+            const std::optional<double> d1 = polygonProjectionDistance(closedA, noOffset, closedB, offset, PointD(vx, vy));
+            const std::optional<double> d2 = polygonProjectionDistance(closedB, offset, closedA, noOffset, PointD(-vx, -vy));
+            std::optional<double> d;
+            if (d1 && d2) d = std::min(*d1, *d2);
+            else if (d1) d = d1;
+            else if (d2) d = d2;
+
+            // Only slide until no longer negative
+            if (!d || almostEqual(*d, 0) || *d <= 0) {
+                continue;
+            }
+
+            const double vd2 = vx * vx + vy * vy;
+            if (*d * *d < vd2 && !almostEqual(*d * *d, vd2)) {
+                const double vd = std::sqrt(vd2);
+                vx *= *d / vd;
+                vy *= *d / vd;
+            }
+            offset.x += vx;
+            offset.y += vy;
+
+            bInside = bIsInside(offset, bInside);
+            if (isStartPoint(offset, *bInside)) {
+                return offset;
+            }
+        }
+    }
+    return std::nullopt;
+}
+
+// Candidate translation while B touches A. markStart/markEnd are the A vertices the move
+// follows (-1 for B vertices); they are marked as visited when the vector is taken.
+struct TranslationVector {
+    PointD vector;
+    int markStart;
+    int markEnd;
+};
+
+} // namespace
+
+PathsD OrbitalNfp::noFitPolygon(const PathD& A, const PathD& B, bool inside, bool searchEdges) {
+    PathsD nfpList;
+    if (A.size() < 3 || B.size() < 3) {
+        return nfpList;
+    }
+    const int sizeA = static_cast<int>(A.size());
+    const int sizeB = static_cast<int>(B.size());
+    std::vector<bool> marked(A.size() + 1, false);
+
+    int minAIndex = 0;
+    for (int i = 1; i < sizeA; ++i) {
+        if (A[i].y < A[minAIndex].y) minAIndex = i;
+    }
+    int maxBIndex = 0;
+    for (int i = 1; i < sizeB; ++i) {
+        if (B[i].y > B[maxBIndex].y) maxBIndex = i;
+    }
+
+    std::optional<PointD> startPoint;
+    if (!inside) {
+        // Put the top-most point of B on the bottom-most point of A: no overlap to start with.
+        startPoint = PointD(A[minAIndex].x - B[maxBIndex].x, A[minAIndex].y - B[maxBIndex].y);
+    } else {
+        // No reliable heuristic for inside
+        startPoint = searchStartPoint(A, B, true, nfpList, marked);
+    }
+
+    while (startPoint) {
+        PointD offsetB = *startPoint;
+        std::optional<PointD> prevVector; // Keep track of the previous vector
+
+        PathD nfp;
+        PointD reference = offsetPoint(B[0], offsetB);
+        const PointD start = reference;
+        nfp.push_back(reference);
+        bool closed = true;
+
+        int counter = 0;
+        while (counter < 10 * (sizeA + sizeB)) { // Sanity check, prevent infinite loop
+            // Find touching vertices/edges: 0 = vertex on vertex, 1 = B vertex on A edge, 2 = A vertex on B edge
+            struct Touch { int type; int a; int b; };
+            std::vector<Touch> touching;
+            for (int i = 0; i < sizeA; ++i) {
+                const int nexti = (i == sizeA - 1) ? 0 : i + 1;
+                for (int j = 0; j < sizeB; ++j) {
+                    const int nextj = (j == sizeB - 1) ? 0 : j + 1;
+                    const PointD bj = offsetPoint(B[j], offsetB);
+                    if (almostEqualPoints(A[i], bj)) {
+                        touching.push_back({0, i, j});
+                    } else if (onSegment(A[i], A[nexti], bj)) {
+                        touching.push_back({1, nexti, j});
+                    } else if (onSegment(bj, offsetPoint(B[nextj], offsetB), A[i])) {
+                        touching.push_back({2, i, nextj});
+                    }
+                }
+            }
+
+            // Generate translation vectors from the touching vertices/edges
+            std::vector<TranslationVector> vectors;
+            for (const Touch& touch : touching) {
+                const PointD& vertexA = A[touch.a];
+                marked[touch.a] = true;
+
+                const int prevAIndex = (touch.a - 1 < 0) ? sizeA - 1 : touch.a - 1;
+                const int nextAIndex = (touch.a + 1 >= sizeA) ? 0 : touch.a + 1;
+                const PointD& prevA = A[prevAIndex];
+                const PointD& nextA = A[nextAIndex];
+
+                const PointD& vertexB = B[touch.b];
+                const int prevBIndex = (touch.b - 1 < 0) ? sizeB - 1 : touch.b - 1;
+                const int nextBIndex = (touch.b + 1 >= sizeB) ? 0 : touch.b + 1;
+                const PointD& prevB = B[prevBIndex];
+                const PointD& nextB = B[nextBIndex];
+
+                if (touch.type == 0) {
+                    vectors.push_back({PointD(prevA.x - vertexA.x, prevA.y - vertexA.y), touch.a, prevAIndex});
+                    vectors.push_back({PointD(nextA.x - vertexA.x, nextA.y - vertexA.y), touch.a, nextAIndex});
+                    // B vectors need to be inverted
+                    vectors.push_back({PointD(vertexB.x - prevB.x, vertexB.y - prevB.y), -1, -1});
+                    vectors.push_back({PointD(vertexB.x - nextB.x, vertexB.y - nextB.y), -1, -1});
+                } else if (touch.type == 1) {
+                    vectors.push_back({PointD(vertexA.x - (vertexB.x + offsetB.x), vertexA.y - (vertexB.y + offsetB.y)),
+                                       prevAIndex, touch.a});
+                    vectors.push_back({PointD(prevA.x - (vertexB.x + offsetB.x), prevA.y - (vertexB.y + offsetB.y)),
+                                       touch.a, prevAIndex});
+                } else {
+                    vectors.push_back({PointD(vertexA.x - (vertexB.x + offsetB.x), vertexA.y - (vertexB.y + offsetB.y)),
+                                       -1, -1});
+                    vectors.push_back({PointD(vertexA.x - (prevB.x + offsetB.x), vertexA.y - (prevB.y + offsetB.y)),
+                                       -1, -1});
+                }
+            }
+
+            // Take the vector that allows the longest slide.
+            const TranslationVector* translate = nullptr;
+            double maxd = 0;
+            for (const TranslationVector& candidate : vectors) {
+                const PointD& v = candidate.vector;
+                if (v.x == 0 && v.y == 0) {
+                    continue;
+                }
+
+                // Ignore a vector pointing back to where we came from (cross product 0, dot product < 0),
+                // comparing unit vectors.
+                if (prevVector && v.y * prevVector->y + v.x * prevVector->x < 0) {
+                    const double vectorLength = std::sqrt(v.x * v.x + v.y * v.y);
+                    const PointD unitV(v.x / vectorLength, v.y / vectorLength);
+                    const double prevLength = std::sqrt(prevVector->x * prevVector->x + prevVector->y * prevVector->y);
+                    const PointD prevUnit(prevVector->x / prevLength, prevVector->y / prevLength);
+                    if (std::abs(unitV.y * prevUnit.x - unitV.x * prevUnit.y) < 0.0001) {
+                        continue;
+                    }
+                }
+
+                std::optional<double> d = polygonSlideDistance(A, B, offsetB, v, true);
+                const double vecd2 = v.x * v.x + v.y * v.y;
+                if (!d || *d * *d > vecd2) {
+                    d = std::sqrt(vecd2);
+                }
+                if (*d > maxd) {
+                    maxd = *d;
+                    translate = &candidate;
+                }
+            }
+
+            if (!translate || almostEqual(maxd, 0)) {
+                closed = false; // Didn't close the loop, something went wrong here
+                break;
+            }
+
+            if (translate->markStart >= 0) marked[translate->markStart] = true;
+            if (translate->markEnd >= 0) marked[translate->markEnd] = true;
+
+            // Trim to the slide distance
+            PointD step = translate->vector;
+            const double vlength2 = step.x * step.x + step.y * step.y;
+            if (maxd * maxd < vlength2 && !almostEqual(maxd * maxd, vlength2)) {
+                const double scale = std::sqrt((maxd * maxd) / vlength2);
+                step.x *= scale;
+                step.y *= scale;
+            }
+            prevVector = step;
+
+            reference.x += step.x;
+            reference.y += step.y;
+
+            if (almostEqualPoints(reference, start)) {
+                break; // We've made a full loop
+            }
+
+            // If A and B start on a touching horizontal line, the end point may not be the start point
+            bool looped = false;
+            for (size_t i = 0; i + 1 < nfp.size(); ++i) {
+                if (almostEqualPoints(reference, nfp[i])) {
+                    looped = true;
+                }
+            }
+            if (looped) {
+                break; // We've made a full loop
+            }
+
+            nfp.push_back(reference);
+            offsetB.x += step.x;
+            offsetB.y += step.y;
+            ++counter;
+        }
+
+        if (closed && !nfp.empty()) {
+            nfpList.push_back(nfp);
+        }
+
+        if (!searchEdges) {
+            break; // Only the outer NFP or the first inner NFP
+        }
+        startPoint = searchStartPoint(A, B, inside, nfpList, marked);
+    }
+
+    // The loops trace B's first vertex; report them for B's origin like the Minkowski backends.
+    for (PathD& nfp : nfpList) {
+        for (PointD& p : nfp) {
+            p.x -= B[0].x;
+            p.y -= B[0].y;
+        }
+    }
+    return nfpList;
+}
+
+} // namespace Geometry
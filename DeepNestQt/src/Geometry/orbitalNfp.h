@@ -0,0 +1,25 @@
+#ifndef ORBITALNFP_H
+#define ORBITALNFP_H
+
+#include "Clipper2/clipper.h" // For Clipper2Lib::PathD
+
+namespace Geometry {
+
+// Orbital (sliding) No-Fit Polygon, a port of DeepNest's GeometryUtil.noFitPolygon
+// (main/util/geometryutil.js). B is slid around A (or inside it) edge by edge, keeping contact,
+// and the loop traced by B's reference point is the NFP. Every vertex is an exact touching position.
+// Works in document units with the JS tolerance (1e-9); both polygons must be counter-clockwise
+// (positive Clipper2 area), which is the winding DeepNest normalizes all parts to.
+class OrbitalNfp {
+public:
+    // Loops traced by B's origin (B's coordinates are relative to its own origin), in A's coordinates.
+    // Outside: the first loop is the outer NFP; with 'searchEdges' further loops are found for
+    // interlocking positions inside A's concavities. Inside: loops where B fits inside A; without
+    // 'searchEdges' only the first one. Empty if the orbit could not be closed, or if B does not
+    // fit inside A.
+    static Clipper2Lib::PathsD noFitPolygon(const Clipper2Lib::PathD& A, const Clipper2Lib::PathD& B,
+                                            bool inside, bool searchEdges);
+};
+
+} // namespace Geometry
+#endif // ORBITALNFP_H
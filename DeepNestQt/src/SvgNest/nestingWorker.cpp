@@ -47,6 +47,24 @@ void ensureCorrectOrientation(QPolygonF& polygon, bool isHole) {
     }
 }
 
+// Offsets a shape by 'delta' document units (GeometryUtils::offsetRegion at the fixed-point 'scale'):
+// outward for delta > 0, inward for delta < 0. Returns false if nothing is left.
+static bool offsetShape(QPolygonF& outer, QList<QPolygonF>& holes, double delta, double scale) {
+    const Clipper2Lib::Paths64 region = GeometryUtils::offsetRegion(
+        GeometryUtils::orientedRegion(GeometryUtils::toPath64(outer, scale), GeometryUtils::toPaths64(holes, scale)),
+        delta * scale);
+    if (region.empty()) return false;
+
+    outer = GeometryUtils::fromPath64(region.front(), scale);
+    ensureCorrectOrientation(outer, false);
+    holes.clear();
+    for (size_t i = 1; i < region.size(); ++i) {
+        QPolygonF hole = GeometryUtils::fromPath64(region[i], scale);
+        ensureCorrectOrientation(hole, true);
+        holes.append(hole);
+    }
+    return true;
+}
 
 Core::InternalPart NestingWorker::convertPathToInternalPart(const QString& id, const QPainterPath& painterPath, double curveTolerance) {
     Core::InternalPart part;
@@ -152,6 +170,21 @@ void NestingWorker::preprocessInputs() {
             if(!basePart.outerBoundary.isEmpty()) basePart.bounds = basePart.outerBoundary.boundingRect(); else basePart.bounds = QRectF();
         }
 
+        // Spacing (kerf): every part grows by half of it, so two parts in contact keep the full
+        // spacing between them. Done once here, all NFPs are computed on the grown geometry.
+        if (config_.spacing > 0) {
+            offsetShape(basePart.outerBoundary, basePart.holes, 0.5 * config_.spacing, config_.clipperScale);
+            basePart.bounds = basePart.outerBoundary.boundingRect();
+        }
+
+        // Computed once per distinct input; all instances below share it and therefore their NFPs.
+        basePart.fingerprint = GeometryUtils::geometryFingerprint(basePart.outerBoundary, basePart.holes);
+        basePart.buildPath64(config_.clipperScale); // NFPs are computed on this fixed-point copy
+        basePart.isConvex = GeometryUtils::isConvex(basePart.outerBoundary); // Enables the linear convex NFP kernel
+        if (config_.nfpBackend == "decomposition") {
+            basePart.buildConvexPieces(); // Once per distinct part, shared by all instances
+        }
+
         for (int i = 0; i < quantity; ++i) {
             internalParts_.append(basePart);
         }
@@ -176,6 +209,17 @@ void NestingWorker::preprocessInputs() {
              sheet.holes = simplifiedHoles;
              if(!sheet.outerBoundary.isEmpty()) sheet.bounds = sheet.outerBoundary.boundingRect(); else sheet.bounds = QRectF();
         }
+        // Sheets shrink by half the spacing (as in the JS), keeping parts a full spacing from the edges and cutouts.
+        if (config_.spacing > 0) {
+            if (!offsetShape(sheet.outerBoundary, sheet.holes, -0.5 * config_.spacing, config_.clipperScale)) {
+                qWarning() << "Sheet" << sheet.id << "is narrower than the spacing, skipping it.";
+                continue;
+            }
+            sheet.bounds = sheet.outerBoundary.boundingRect();
+        }
+        sheet.fingerprint = GeometryUtils::geometryFingerprint(sheet.outerBoundary, sheet.holes);
+        sheet.buildPath64(config_.clipperScale);
+        sheet.isConvex = GeometryUtils::isConvex(sheet.outerBoundary);
         internalSheets_.append(sheet);
     }
     qDebug() << "Converted" << internalSheets_.size() << "sheets.";
@@ -195,6 +239,7 @@ void NestingWorker::process() {
     }
     
     Core::NestingEngine nestingEngine(config_, internalParts_, internalSheets_);
+    nestingEngine.setProgressCallback([this](int percentage) { emit progress(percentage); });
     // For NestingEngine to be interruptible by this worker's stopRequested_ flag,
     // it needs to be designed to check this flag. One way is to pass a pointer/reference:
     // nestingEngine.setStopFlag(&stopRequested_); (This method needs to be added to NestingEngine)
@@ -208,6 +253,7 @@ void NestingWorker::process() {
 
     qDebug() << "NestingWorker: Starting main nesting logic via NestingEngine.";
     allSolutions = nestingEngine.runNesting(); // This is a blocking call.
+    emit nfpStatistics(nestingEngine.nfpStatistics());
 
     if (stopRequested_) {
         qDebug() << "NestingWorker: Process completed or interrupted due to stop request after NestingEngine attempt.";
@@ -6,6 +6,7 @@
 #include <QString>
 #include <QList>
 #include <QPainterPath> // Required for QPair<QPainterPath, int>
+#include <QJsonObject>
 #include <internalTypes.h>
 
 // Forward declare SvgNest types to avoid circular dependency if full SvgNest.h is not needed
@@ -29,6 +30,7 @@ signals:
     void progress(int percentage);
     void newSolution(const SvgNest::NestSolution& solution);
     void finished(const QList<SvgNest::NestSolution>& allSolutions); // O solo la migliore
+    void nfpStatistics(const QJsonObject& statistics); // Statistiche della cache NFP, emesse prima di finished
 
 private:
     // Dati di input (copie o riferimenti costanti)
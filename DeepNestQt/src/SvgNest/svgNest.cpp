@@ -109,6 +109,7 @@ void SvgNest::startNestingAsync() {
     // Data connections
     connect(worker_, &NestingWorker::progress, this, &SvgNest::handleWorkerProgress);
     connect(worker_, &NestingWorker::newSolution, this, &SvgNest::handleWorkerNewSolution);
+    connect(worker_, &NestingWorker::nfpStatistics, this, &SvgNest::handleWorkerNfpStatistics);
     
     workerThread_->start();
     qDebug() << "Nesting worker thread started.";
@@ -186,6 +187,11 @@ void SvgNest::handleWorkerNewSolution(const SvgNest::NestSolution& solution) {
     emit newSolutionFound(solution);
 }
 
+void SvgNest::handleWorkerNfpStatistics(const QJsonObject& statistics) {
+    lastNfpStatistics_ = statistics;
+    emit nfpStatisticsAvailable(statistics);
+}
+
 void SvgNest::registerType()
 {
     qRegisterMetaType<SvgNest::NestSolution>("SvgNest::NestSolution");
@@ -10,6 +10,7 @@
 #include <QPointF>
 #include <QPolygonF>
 #include <QThread> // Per operazioni asincrone
+#include <QJsonObject> // Per le statistiche NFP
 
 // Eventuale forward declaration per classi interne
 class NestingWorker; // Classe worker che gira in un thread separato
@@ -22,7 +23,7 @@ public:
     struct Configuration {
         double clipperScale = 10000000.0;
         double curveTolerance = 0.3; // Tolleranza per la conversione curve->polilinee
-        double spacing = 0.0;        // Spaziatura tra le parti
+        double spacing = 0.0;        // Spaziatura tra le parti (e dai bordi dei fogli), applicata una volta in preelaborazione
         int rotations = 4;           // Numero di rotazioni da provare (es. 0, 90, 180, 270)
         int populationSize = 10;     // Dimensione popolazione per Algoritmo Genetico
         int mutationRate = 10;       // Percentuale tasso di mutazione per GA
@@ -30,6 +31,14 @@ public:
         bool mergeLines = true;          // Unire linee collineari nell'output
         double timeRatio = 0.5;          // Bilanciamento tra uso materiale e tempo di taglio (per mergeLines)
         bool simplifyOnLoad = false;     // Semplificare i tracciati in input
+        int nfpCacheShards = 0;          // Numero di shard della cache NFP (0 = automatico in base ai core, 1 = lock singolo)
+        qint64 nfpCacheMemoryBudget = 0; // Budget di memoria della cache NFP in byte (0 = illimitato)
+        QString nfpCacheDirectory;       // Cartella della cache NFP persistente su disco (vuota = disabilitata)
+        bool precomputeNfps = true;      // Precalcolare in parallelo gli NFP di tutte le forme e rotazioni prima di avviare il GA (si ferma al budget di memoria)
+        QString nfpBackend = "clipper2"; // Motore NFP: "clipper2" (somma di Minkowski), "decomposition" (pezzi convessi) o "orbital" (scorrimento); placementType "deepnest" usa il modulo originale
+        bool exploreConcave = false;     // Solo backend "orbital": cercare anche le posizioni incastrate nelle concavità (più lento)
+        int placementCheckpointInterval = 8; // Ogni quanti geni salvare lo stato di piazzamento, riusato dagli individui con lo stesso prefisso (0 = disabilitato)
+        qint64 placementCheckpointMemoryBudget = 256LL * 1024 * 1024; // Budget di memoria degli stati di piazzamento salvati in byte (0 = illimitato)
         // Altri parametri rilevanti...
     };
 
@@ -65,21 +74,28 @@ public:
     void startNestingAsync();
     void stopNesting(); // Richiede l'interruzione del processo
 
+    // Statistiche della cache NFP dell'ultimo nesting completato (hit/miss, attese single-flight,
+    // evizioni, byte, voci e istogrammi dei tempi di calcolo per backend). Vuoto prima del primo nesting.
+    QJsonObject nfpStatistics() const { return lastNfpStatistics_; }
+
     static void registerType();
 signals:
     void nestingProgress(int percentage); // Percentuale di progresso (0-100)
     void newSolutionFound(const SvgNest::NestSolution& solution); // Nuova soluzione trovata dal GA
     void nestingFinished(const QList<SvgNest::NestSolution>& allSolutions); // Processo completato
+    void nfpStatisticsAvailable(const QJsonObject& statistics); // Statistiche NFP, emesse prima di nestingFinished
 
 private slots:
     void handleWorkerFinished(const QList<SvgNest::NestSolution>& allSolutions); // Slot per gestire la fine del lavoro del thread worker
     void handleWorkerProgress(int percentage);
     void handleWorkerNewSolution(const SvgNest::NestSolution& solution);
+    void handleWorkerNfpStatistics(const QJsonObject& statistics);
 
 private:
     Configuration currentConfig_;
     QHash<QString, QPair<QPainterPath, int>> partsToNest_; // ID -> (Path, Quantità)
     QList<QPainterPath> sheets_; // Lista di fogli disponibili
+    QJsonObject lastNfpStatistics_;
 
     QThread* workerThread_;
     NestingWorker* worker_; // Oggetto che esegue il lavoro pesante in un thread separato
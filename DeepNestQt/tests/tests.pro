@@ -1,4 +1,4 @@
-QT       += testlib core gui # gui for QPainterPath
+QT       += testlib core gui concurrent # gui for QPainterPath, concurrent for the engine sources
 TARGET = tst_DeepNestQt
 CONFIG += console
 CONFIG -= app_bundle
@@ -20,14 +20,23 @@ SOURCES += \
     $$DEEPNESTQT_SRC_DIR/SvgNest/nestingWorker.cpp \
     $$DEEPNESTQT_SRC_DIR/SvgNest/placementTypes.cpp \
     $$DEEPNESTQT_SRC_DIR/Core/nestingEngine.cpp \
+    $$DEEPNESTQT_SRC_DIR/Core/feasibleRegion.cpp \
+    $$DEEPNESTQT_SRC_DIR/Core/placementTrie.cpp \
+    $$DEEPNESTQT_SRC_DIR/Core/obstacleUnion.cpp \
     $$DEEPNESTQT_SRC_DIR/Core/geneticAlgorithm.cpp \
     $$DEEPNESTQT_SRC_DIR/Core/internalTypes.cpp \
     $$DEEPNESTQT_SRC_DIR/Geometry/SimplifyPath.cpp \
     $$DEEPNESTQT_SRC_DIR/Geometry/HullPolygon.cpp \
+    $$DEEPNESTQT_SRC_DIR/Geometry/minkowskiQuads.cpp \
+    $$DEEPNESTQT_SRC_DIR/Geometry/batchPointInPolygon.cpp \
     $$DEEPNESTQT_SRC_DIR/Geometry/geometryUtils.cpp \
     $$DEEPNESTQT_SRC_DIR/Geometry/nfpGenerator.cpp \
     $$DEEPNESTQT_SRC_DIR/Geometry/nfpCache.cpp \
+    $$DEEPNESTQT_SRC_DIR/Geometry/nfpDiskStore.cpp \
+    $$DEEPNESTQT_SRC_DIR/Geometry/nfpStats.cpp \
+    $$DEEPNESTQT_SRC_DIR/Geometry/orbitalNfp.cpp \
     $$DEEPNESTQT_SRC_DIR/External/Minkowski/minkowski_wrapper.cpp \
+    $$DEEPNESTQT_SRC_DIR/External/Minkowski/minkowski_thread_wrapper.cpp \
     # Clipper2 sources
     $$DEEPNESTQT_SRC_DIR/External/Clipper2/Cpp/Clipper2Lib/clipper.engine.cpp \
     $$DEEPNESTQT_SRC_DIR/External/Clipper2/Cpp/Clipper2Lib/clipper.offset.cpp \
@@ -6,11 +6,29 @@
 #include "HullPolygon.h"    // For Geometry::HullPolygon
 #include "geometryUtils.h"  // For GeometryUtils
 #include "nfpCache.h"       // For Geometry::NfpCache
+#include "nfpDiskStore.h"   // For Geometry::NfpDiskStore
+#include "nfpGenerator.h"   // For Geometry::NfpGenerator
+#include "orbitalNfp.h"     // For Geometry::OrbitalNfp
+#include "minkowskiQuads.h" // For Geometry::MinkowskiQuads
+#include "batchPointInPolygon.h" // For Geometry::BatchPointInPolygon
+#include "minkowski_thread_wrapper.h" // For CustomMinkowski::CalculateNfp_Batch_MultiThreaded
+#include "feasibleRegion.h" // For Core::FeasibleRegion
+#include "placementTrie.h"  // For Core::PlacementTrie
+#include "obstacleUnion.h"  // For Core::ObstacleUnion
 #include "internalTypes.h"  // For Core::InternalPart (if directly testing conversion/NFP)
 
 #include <QPainterPath>
 #include <QPolygonF>
 #include <QRectF>
+#include <QTemporaryDir>
+#include <QDir>
+#include <QTransform>
+#include <QJsonObject>
+#include <QtConcurrent/QtConcurrent>
+#include <QtMath>
+#include <algorithm>
+#include <limits>
+#include <stdexcept>
 #include <cmath> // For std::abs, M_PI_2 for rotations
 
 TestSvgNest::TestSvgNest() : nestInstance(nullptr) {
@@ -168,52 +186,1264 @@ void TestSvgNest::testGeometryUtilsArea() {
     }
 }
 
+void TestSvgNest::testGeometryFingerprint_data() {
+    QTest::addColumn<QPolygonF>("outer");
+    QTest::addColumn<QList<QPolygonF>>("holes");
+    QTest::addColumn<QPolygonF>("otherOuter");
+    QTest::addColumn<QList<QPolygonF>>("otherHoles");
+    QTest::addColumn<bool>("sameShape");
+
+    QPolygonF square;
+    square << QPointF(0,0) << QPointF(10,0) << QPointF(10,10) << QPointF(0,10);
+    QPolygonF holeA;
+    holeA << QPointF(2,2) << QPointF(4,2) << QPointF(4,4);
+    QPolygonF holeB;
+    holeB << QPointF(6,6) << QPointF(8,6) << QPointF(8,8);
+    const QList<QPolygonF> holes = QList<QPolygonF>() << holeA << holeB;
+
+    QPolygonF rotatedStart;
+    rotatedStart << QPointF(10,10) << QPointF(0,10) << QPointF(0,0) << QPointF(10,0);
+    QTest::newRow("start_vertex") << square << holes << rotatedStart << holes << true;
+
+    QPolygonF noisy;
+    noisy << QPointF(1e-9,0) << QPointF(10,-1e-9) << QPointF(10.000000001,10) << QPointF(0,10);
+    QTest::newRow("float_noise") << square << holes << noisy << holes << true;
+
+    QPolygonF closed = square;
+    closed << square.first();
+    QTest::newRow("closing_vertex") << square << holes << closed << holes << true;
+
+    QTest::newRow("hole_order") << square << holes << square << (QList<QPolygonF>() << holeB << holeA) << true;
+
+    QTest::newRow("translated") << square << holes << square.translated(5, 0) << holes << false;
+
+    QPolygonF reversed;
+    for (int i = square.size() - 1; i >= 0; --i) reversed << square[i];
+    QTest::newRow("orientation") << square << holes << reversed << holes << false;
+
+    QTest::newRow("missing_hole") << square << holes << square << (QList<QPolygonF>() << holeA) << false;
+}
+
+void TestSvgNest::testGeometryFingerprint() {
+    QFETCH(QPolygonF, outer);
+    QFETCH(QList<QPolygonF>, holes);
+    QFETCH(QPolygonF, otherOuter);
+    QFETCH(QList<QPolygonF>, otherHoles);
+    QFETCH(bool, sameShape);
+
+    const quint64 fingerprint = GeometryUtils::geometryFingerprint(outer, holes);
+    QVERIFY(fingerprint != 0);
+    QCOMPARE(GeometryUtils::geometryFingerprint(outer, holes), fingerprint); // Deterministic
+    QCOMPARE(GeometryUtils::geometryFingerprint(otherOuter, otherHoles) == fingerprint, sameShape);
+}
+
 // --- Test NfpCache ---
+// --- Test convex fast path ---
+void TestSvgNest::testIsConvex_data() {
+    QTest::addColumn<QPolygonF>("polygon");
+    QTest::addColumn<bool>("expectedConvex");
+
+    QPolygonF square;
+    square << QPointF(0,0) << QPointF(10,0) << QPointF(10,10) << QPointF(0,10);
+    QTest::newRow("square") << square << true;
+
+    QPolygonF cw_square;
+    cw_square << QPointF(0,0) << QPointF(0,10) << QPointF(10,10) << QPointF(10,0);
+    QTest::newRow("cw_square") << cw_square << true;
+
+    QPolygonF collinear; // Extra vertex in the middle of an edge
+    collinear << QPointF(0,0) << QPointF(5,0) << QPointF(10,0) << QPointF(10,10) << QPointF(0,10);
+    QTest::newRow("collinear_vertex") << collinear << true;
+
+    QPolygonF lShape;
+    lShape << QPointF(0,0) << QPointF(10,0) << QPointF(10,5) << QPointF(5,5) << QPointF(5,10) << QPointF(0,10);
+    QTest::newRow("l_shape") << lShape << false;
+
+    QPolygonF bowtie; // Self-intersecting, same hull as the square
+    bowtie << QPointF(0,0) << QPointF(10,10) << QPointF(10,0) << QPointF(0,10);
+    QTest::newRow("bowtie") << bowtie << false;
+}
+
+void TestSvgNest::testIsConvex() {
+    QFETCH(QPolygonF, polygon);
+    QFETCH(bool, expectedConvex);
+    QCOMPARE(GeometryUtils::isConvex(polygon), expectedConvex);
+}
+
+void TestSvgNest::testConvexMinkowskiSum_data() {
+    QTest::addColumn<QPolygonF>("polygonA");
+    QTest::addColumn<QPolygonF>("polygonB");
+
+    QPolygonF square;
+    square << QPointF(0,0) << QPointF(10,0) << QPointF(10,10) << QPointF(0,10);
+    QPolygonF triangle;
+    triangle << QPointF(100,0) << QPointF(104,0) << QPointF(100,4);
+    QTest::newRow("square_triangle") << square << triangle;
+
+    QPolygonF cw_triangle(triangle);
+    std::reverse(cw_triangle.begin(), cw_triangle.end());
+    QTest::newRow("square_cw_triangle") << square << cw_triangle;
+
+    QPolygonF hexagon;
+    for (int i = 0; i < 6; ++i) {
+        const double angle = qDegreesToRadians(60.0 * i + 7.0);
+        hexagon << QPointF(20 + 8 * std::cos(angle), -3 + 5 * std::sin(angle));
+    }
+    QTest::newRow("square_hexagon") << square << hexagon;
+    QTest::newRow("hexagon_rotated_square") << hexagon << QTransform().rotate(33).map(square);
+}
+
+void TestSvgNest::testConvexMinkowskiSum() {
+    QFETCH(QPolygonF, polygonA);
+    QFETCH(QPolygonF, polygonB);
+    const double scale = 1000.0;
+    const Clipper2Lib::Path64 a = GeometryUtils::toPath64(polygonA, scale);
+    const Clipper2Lib::Path64 b = GeometryUtils::toPath64(polygonB, scale);
+
+    const Clipper2Lib::Path64 sum = GeometryUtils::minkowskiSumConvex(a, b);
+    QVERIFY(sum.size() <= a.size() + b.size());
+    QVERIFY(Clipper2Lib::Area(sum) > 0);
+
+    // Clipper2 sweeps one boundary along the other; its outer ring is the full sum.
+    Clipper2Lib::Paths64 reference;
+    for (const Clipper2Lib::Path64& path : Clipper2Lib::MinkowskiSum(a, b, true)) {
+        if (Clipper2Lib::Area(path) > 0) reference.push_back(path);
+    }
+    QCOMPARE(reference.size(), size_t(1));
+    const Clipper2Lib::Paths64 difference = Clipper2Lib::Xor(Clipper2Lib::Paths64{sum}, reference,
+                                                             Clipper2Lib::FillRule::NonZero);
+    QVERIFY(Clipper2Lib::Area(difference) <= 1e-9 * Clipper2Lib::Area(reference));
+}
+
+void TestSvgNest::testConvexDecomposition_data() {
+    QTest::addColumn<QPolygonF>("polygon");
+    QTest::addColumn<int>("maxPieces");
+
+    QPolygonF square;
+    square << QPointF(0,0) << QPointF(10,0) << QPointF(10,10) << QPointF(0,10);
+    QTest::newRow("square") << square << 1;
+
+    QPolygonF lShape;
+    lShape << QPointF(0,0) << QPointF(10,0) << QPointF(10,5) << QPointF(5,5) << QPointF(5,10) << QPointF(0,10);
+    QTest::newRow("l_shape") << lShape << 2;
+
+    QPolygonF cw_lShape(lShape);
+    std::reverse(cw_lShape.begin(), cw_lShape.end());
+    QTest::newRow("cw_l_shape") << cw_lShape << 2;
+
+    QPolygonF comb; // Three teeth
+    comb << QPointF(0,0) << QPointF(15,0) << QPointF(15,10) << QPointF(13,10) << QPointF(13,3)
+         << QPointF(9,3) << QPointF(9,10) << QPointF(6,10) << QPointF(6,3) << QPointF(2,3) << QPointF(2,10) << QPointF(0,10);
+    QTest::newRow("comb") << comb << 8;
+
+    QPolygonF star;
+    for (int i = 0; i < 10; ++i) {
+        const double angle = qDegreesToRadians(36.0 * i);
+        const double radius = (i % 2 == 0) ? 10.0 : 4.0;
+        star << QPointF(radius * std::cos(angle), radius * std::sin(angle));
+    }
+    QTest::newRow("star") << star << 8;
+}
+
+void TestSvgNest::testConvexDecomposition() {
+    QFETCH(QPolygonF, polygon);
+    QFETCH(int, maxPieces);
+    const Clipper2Lib::Path64 path = GeometryUtils::toPath64(polygon, 1000.0);
+
+    const Clipper2Lib::Paths64 pieces = GeometryUtils::convexDecomposition(path);
+    QVERIFY(!pieces.empty());
+    QVERIFY(static_cast<int>(pieces.size()) <= maxPieces);
+    double piecesArea = 0.0;
+    for (const Clipper2Lib::Path64& piece : pieces) {
+        QVERIFY(Clipper2Lib::Area(piece) > 0);
+        for (size_t i = 0; i < piece.size(); ++i) {
+            QVERIFY(Clipper2Lib::CrossProductSign(piece[(i + piece.size() - 1) % piece.size()], piece[i],
+                                                  piece[(i + 1) % piece.size()]) >= 0);
+        }
+        piecesArea += Clipper2Lib::Area(piece);
+    }
+    // The pieces tile the polygon exactly.
+    QCOMPARE(piecesArea, std::abs(Clipper2Lib::Area(path)));
+    QCOMPARE(Clipper2Lib::Area(Clipper2Lib::Xor(pieces, Clipper2Lib::Paths64{path}, Clipper2Lib::FillRule::NonZero)), 0.0);
+
+    // The union of the piecewise convex sums is the Minkowski sum (outer ring of Clipper2's sweep).
+    const Clipper2Lib::Path64 tool = {{0,0}, {3000,0}, {3000,2000}, {0,2000}};
+    Clipper2Lib::Paths64 sums;
+    for (const Clipper2Lib::Path64& piece : pieces) {
+        sums.push_back(GeometryUtils::minkowskiSumConvex(tool, piece));
+    }
+    const Clipper2Lib::Paths64 nfp = Clipper2Lib::Union(sums, Clipper2Lib::FillRule::NonZero);
+    Clipper2Lib::Paths64 reference;
+    for (const Clipper2Lib::Path64& ring : Clipper2Lib::MinkowskiSum(tool, path, true)) {
+        if (Clipper2Lib::Area(ring) > 0) reference.push_back(ring);
+    }
+    reference = Clipper2Lib::Union(reference, Clipper2Lib::FillRule::NonZero);
+    QCOMPARE(Clipper2Lib::Area(Clipper2Lib::Xor(nfp, reference, Clipper2Lib::FillRule::NonZero)), 0.0);
+}
+
+void TestSvgNest::testOrbitalNfp_data() {
+    QTest::addColumn<QPolygonF>("staticPart");
+    QTest::addColumn<QPolygonF>("orbitingPart");
+    QTest::addColumn<bool>("inside");
+    QTest::addColumn<bool>("searchEdges");
+    QTest::addColumn<QList<double>>("loopAreas"); // Absolute area of each loop, in order
+
+    QPolygonF square;
+    square << QPointF(0,0) << QPointF(10,0) << QPointF(10,10) << QPointF(0,10);
+    QPolygonF small;
+    small << QPointF(0,0) << QPointF(2,0) << QPointF(2,2) << QPointF(0,2);
+    QPolygonF triangle;
+    triangle << QPointF(0,0) << QPointF(4,0) << QPointF(2,3);
+    QPolygonF lShape;
+    lShape << QPointF(0,0) << QPointF(10,0) << QPointF(10,4) << QPointF(4,4) << QPointF(4,10) << QPointF(0,10);
+    QPolygonF uShape; // Slot 4 wide, open at the top
+    uShape << QPointF(0,0) << QPointF(10,0) << QPointF(10,10) << QPointF(7,10) << QPointF(7,3)
+           << QPointF(3,3) << QPointF(3,10) << QPointF(0,10);
+    QPolygonF cShape; // 6x6 cavity behind a mouth only 2 wide
+    cShape << QPointF(0,0) << QPointF(10,0) << QPointF(10,10) << QPointF(6,10) << QPointF(6,8) << QPointF(8,8)
+           << QPointF(8,2) << QPointF(2,2) << QPointF(2,8) << QPointF(4,8) << QPointF(4,10) << QPointF(0,10);
+    QPolygonF block;
+    block << QPointF(0,0) << QPointF(3,0) << QPointF(3,3) << QPointF(0,3);
+
+    QTest::newRow("square_around_square") << square << small << false << false << QList<double>{144.0};
+    QTest::newRow("triangle_around_square") << square << triangle << false << false << QList<double>{176.0};
+    QTest::newRow("square_inside_square") << square << small << true << false << QList<double>{64.0};
+    QTest::newRow("square_inside_l_shape") << lShape << small << true << false << QList<double>{28.0};
+    QTest::newRow("square_into_u_slot") << uShape << small << false << false << QList<double>{130.0};
+    QTest::newRow("block_outside_c_cavity") << cShape << block << false << false << QList<double>{169.0};
+    QTest::newRow("block_in_c_cavity") << cShape << block << false << true << QList<double>{169.0, 9.0};
+    QTest::newRow("too_big_to_fit") << small << square << true << false << QList<double>();
+}
+
+void TestSvgNest::testOrbitalNfp() {
+    QFETCH(QPolygonF, staticPart);
+    QFETCH(QPolygonF, orbitingPart);
+    QFETCH(bool, inside);
+    QFETCH(bool, searchEdges);
+    QFETCH(QList<double>, loopAreas);
+    auto toPathD = [](const QPolygonF& polygon) {
+        Clipper2Lib::PathD path;
+        for (const QPointF& p : polygon) path.push_back(Clipper2Lib::PointD(p.x(), p.y()));
+        return path;
+    };
+
+    const Clipper2Lib::PathsD loops = Geometry::OrbitalNfp::noFitPolygon(toPathD(staticPart), toPathD(orbitingPart),
+                                                                          inside, searchEdges);
+    QCOMPARE(static_cast<int>(loops.size()), loopAreas.size());
+    for (int i = 0; i < loopAreas.size(); ++i) {
+        QVERIFY(qAbs(std::abs(Clipper2Lib::Area(loops[i])) - loopAreas[i]) < 1e-6);
+    }
+
+    // The outer orbit of two convex parts is their Minkowski sum.
+    if (!inside && GeometryUtils::isConvex(staticPart) && GeometryUtils::isConvex(orbitingPart)) {
+        QPolygonF reflected;
+        for (const QPointF& p : orbitingPart) reflected << -p;
+        const Clipper2Lib::Path64 sum = GeometryUtils::minkowskiSumConvex(GeometryUtils::toPath64(staticPart, 1000.0),
+                                                                         GeometryUtils::toPath64(reflected, 1000.0));
+        QVERIFY(qAbs(Clipper2Lib::Area(sum) / 1e6 - loopAreas.first()) < 1e-6);
+    }
+}
+
+void TestSvgNest::testNfpRegions_data() {
+    QTest::addColumn<QPolygonF>("staticPart");  // Static part, or the container for inner NFPs
+    QTest::addColumn<QPolygonF>("staticHole");
+    QTest::addColumn<QPolygonF>("movingPart");
+    QTest::addColumn<bool>("inside");
+    QTest::addColumn<double>("area");           // NonZero area of the region
+    QTest::addColumn<int>("pathCount");
+    QTest::addColumn<QPointF>("freePosition");  // Reference point where the moving part fits
+    QTest::addColumn<QPointF>("blockedPosition");
+
+    QPolygonF flange;
+    flange << QPointF(0,0) << QPointF(20,0) << QPointF(20,20) << QPointF(0,20);
+    QPolygonF flangeCutout;
+    flangeCutout << QPointF(5,5) << QPointF(15,5) << QPointF(15,15) << QPointF(5,15);
+    QPolygonF gasket;
+    gasket << QPointF(0,0) << QPointF(4,0) << QPointF(4,4) << QPointF(0,4);
+    QPolygonF sheet;
+    sheet << QPointF(0,0) << QPointF(30,0) << QPointF(30,30) << QPointF(0,30);
+    QPolygonF sheetCutout;
+    sheetCutout << QPointF(10,10) << QPointF(20,10) << QPointF(20,20) << QPointF(10,20);
+
+    // 24x24 sum minus the 6x6 positions of the gasket inside the cutout.
+    QTest::newRow("gasket_in_flange_cutout") << flange << flangeCutout << gasket << false
+                                             << 540.0 << 2 << QPointF(8,8) << QPointF(2,2);
+    // 26x26 positions on the sheet minus the 14x14 overlapping its cutout.
+    QTest::newRow("sheet_cutout_forbidden") << sheet << sheetCutout << gasket << true
+                                            << 480.0 << 2 << QPointF(2,2) << QPointF(15,15);
+}
+
+void TestSvgNest::testNfpRegions() {
+    QFETCH(QPolygonF, staticPart);
+    QFETCH(QPolygonF, staticHole);
+    QFETCH(QPolygonF, movingPart);
+    QFETCH(bool, inside);
+    QFETCH(double, area);
+    QFETCH(int, pathCount);
+    QFETCH(QPointF, freePosition);
+    QFETCH(QPointF, blockedPosition);
+    const double scale = 1000.0;
+
+    const Clipper2Lib::Paths64 staticRegion = GeometryUtils::orientedRegion(
+        GeometryUtils::toPath64(staticPart, scale), Clipper2Lib::Paths64{GeometryUtils::toPath64(staticHole, scale)});
+    const Clipper2Lib::Paths64 movingRegion = GeometryUtils::orientedRegion(
+        GeometryUtils::toPath64(movingPart, scale), Clipper2Lib::Paths64());
+    Clipper2Lib::Paths64 nfp;
+    if (inside) {
+        nfp = GeometryUtils::minkowskiInnerRegion(staticRegion, movingRegion);
+    } else {
+        Clipper2Lib::Paths64 reflected = movingRegion;
+        for (Clipper2Lib::Path64& path : reflected) {
+            for (Clipper2Lib::Point64& p : path) p = Clipper2Lib::Point64(-p.x, -p.y);
+        }
+        nfp = GeometryUtils::minkowskiSumRegions(staticRegion, reflected);
+    }
+    QCOMPARE(static_cast<int>(nfp.size()), pathCount);
+    QVERIFY(qAbs(Clipper2Lib::Area(nfp) / (scale * scale) - area) < 1e-6);
+
+    // Holes are read with an even-odd rule: inside a hole of the outer NFP is free, inside a
+    // hole of the inner NFP is not.
+    auto covered = [&nfp, scale](const QPointF& position) {
+        const Clipper2Lib::Point64 point(static_cast<int64_t>(position.x() * scale), static_cast<int64_t>(position.y() * scale));
+        bool result = false;
+        for (const Clipper2Lib::Path64& ring : nfp) {
+            if (Clipper2Lib::PointInPolygon(point, ring) == Clipper2Lib::PointInPolygonResult::IsInside) result = !result;
+        }
+        return result;
+    };
+    QCOMPARE(covered(freePosition), inside);
+    QCOMPARE(covered(blockedPosition), !inside);
+}
+
+void TestSvgNest::testRectangleInnerNfp_data() {
+    QTest::addColumn<QPolygonF>("part");
+    QTest::addColumn<QList<QPolygonF>>("sheetHoles");
+    QTest::addColumn<int>("stripSegments"); // Pieces of the inner NFP of a strip as wide as the sheet
+
+    QPolygonF square;
+    square << QPointF(0,0) << QPointF(4,0) << QPointF(4,4) << QPointF(0,4);
+    QPolygonF triangle;
+    triangle << QPointF(0,0) << QPointF(4,0) << QPointF(2,3);
+    QPolygonF lShape;
+    lShape << QPointF(0,0) << QPointF(6,0) << QPointF(6,2) << QPointF(2,2) << QPointF(2,5) << QPointF(0,5);
+    QPolygonF offOrigin; // Reference point outside the part
+    offOrigin << QPointF(-3,2) << QPointF(1,2) << QPointF(1,6) << QPointF(-3,6);
+    QPolygonF cutout;
+    cutout << QPointF(10,10) << QPointF(20,10) << QPointF(20,20) << QPointF(10,20);
+    QPolygonF slantedCutout;
+    slantedCutout << QPointF(22,3) << QPointF(27,3) << QPointF(25,8);
+
+    QTest::newRow("square") << square << QList<QPolygonF>() << 1;
+    QTest::newRow("triangle") << triangle << QList<QPolygonF>() << 1;
+    QTest::newRow("off_origin") << offOrigin << QList<QPolygonF>() << 1;
+    QTest::newRow("square_rect_hole") << square << QList<QPolygonF>{cutout} << 2;
+    QTest::newRow("l_shape_rect_hole") << lShape << QList<QPolygonF>{cutout} << 2;
+    // The slanted cutout leaves only y = 0 below the square one, a single position that is dropped.
+    QTest::newRow("triangle_two_holes") << triangle << QList<QPolygonF>{cutout, slantedCutout} << 1;
+}
+
+void TestSvgNest::testRectangleInnerNfp() {
+    QFETCH(QPolygonF, part);
+    QFETCH(QList<QPolygonF>, sheetHoles);
+    QFETCH(int, stripSegments);
+    const double scale = 1000.0;
+    QPolygonF sheet;
+    sheet << QPointF(0,0) << QPointF(30,0) << QPointF(30,30) << QPointF(0,30);
+
+    Clipper2Lib::Rect64 sheetRect;
+    QVERIFY(GeometryUtils::isAxisAlignedRectangle(GeometryUtils::toPath64(sheet, scale), &sheetRect));
+    Clipper2Lib::Paths64 holes;
+    for (const QPolygonF& hole : sheetHoles) holes.push_back(GeometryUtils::toPath64(hole, scale));
+    const Clipper2Lib::Paths64 partRegion = GeometryUtils::orientedRegion(GeometryUtils::toPath64(part, scale), Clipper2Lib::Paths64());
+
+    // Same region as the general inner NFP.
+    const Clipper2Lib::Paths64 fast = GeometryUtils::rectangleInnerRegion(sheetRect, holes, partRegion);
+    const Clipper2Lib::Paths64 general = GeometryUtils::minkowskiInnerRegion(
+        GeometryUtils::orientedRegion(GeometryUtils::toPath64(sheet, scale), holes), partRegion);
+    QVERIFY(Clipper2Lib::Area(fast) > 0);
+    QVERIFY(qAbs(Clipper2Lib::Area(fast) - Clipper2Lib::Area(general)) < 1e-9 * Clipper2Lib::Area(general));
+    QCOMPARE(Clipper2Lib::Area(Clipper2Lib::Xor(fast, general, Clipper2Lib::FillRule::NonZero)), 0.0);
+
+    // A strip as wide as the sheet keeps the segments of positions beside the holes.
+    QPolygonF strip;
+    strip << QPointF(0,0) << QPointF(30,0) << QPointF(30,3) << QPointF(0,3);
+    const Clipper2Lib::Paths64 segments = GeometryUtils::rectangleInnerRegion(sheetRect, holes,
+        GeometryUtils::orientedRegion(GeometryUtils::toPath64(strip, scale), Clipper2Lib::Paths64()));
+    QCOMPARE(static_cast<int>(segments.size()), stripSegments);
+}
+
+void TestSvgNest::testOffsetRegion_data() {
+    QTest::addColumn<double>("delta");
+    QTest::addColumn<double>("area");
+    QTest::addColumn<int>("ringCount");
+
+    // 20x20 plate with a 10x10 cutout and a 1x1 pin hole near the corner.
+    QTest::newRow("unchanged") << 0.0 << 400.0 - 100.0 - 1.0 << 3;
+    // Part spacing: 22x22 minus the 8x8 cutout; the pin hole closes up.
+    QTest::newRow("grow") << 1.0 << 484.0 - 64.0 << 2;
+    // Sheet spacing: 18x18 minus the 12x12 cutout; the 3x3 pin hole now reaches the edge as a notch.
+    QTest::newRow("shrink") << -1.0 << 324.0 - 144.0 - 9.0 << 2;
+    QTest::newRow("vanish") << -20.0 << 0.0 << 0;
+}
+
+void TestSvgNest::testOffsetRegion() {
+    QFETCH(double, delta);
+    QFETCH(double, area);
+    QFETCH(int, ringCount);
+    const double scale = 1000.0;
+    QPolygonF plate;
+    plate << QPointF(0,0) << QPointF(20,0) << QPointF(20,20) << QPointF(0,20);
+    QPolygonF cutout;
+    cutout << QPointF(5,5) << QPointF(15,5) << QPointF(15,15) << QPointF(5,15);
+    QPolygonF pinHole;
+    pinHole << QPointF(17,17) << QPointF(18,17) << QPointF(18,18) << QPointF(17,18);
+
+    const Clipper2Lib::Paths64 region = GeometryUtils::orientedRegion(GeometryUtils::toPath64(plate, scale),
+                                                                      GeometryUtils::toPaths64({cutout, pinHole}, scale));
+    const Clipper2Lib::Paths64 offset = GeometryUtils::offsetRegion(region, delta * scale);
+    QCOMPARE(static_cast<int>(offset.size()), ringCount);
+    QVERIFY(qAbs(Clipper2Lib::Area(offset) / (scale * scale) - area) < 1e-6);
+    if (!offset.empty()) {
+        QVERIFY(Clipper2Lib::Area(offset.front()) > 0); // Outer first, holes after it
+    }
+}
+
+void TestSvgNest::testMinkowskiQuads_data() {
+    QTest::addColumn<QPolygonF>("a");
+    QTest::addColumn<QPolygonF>("b");
+    QTest::addColumn<int>("quadCount");
+
+    QPolygonF square;
+    square << QPointF(0,0) << QPointF(4,0) << QPointF(4,4) << QPointF(0,4);
+    QPolygonF lShape;
+    lShape << QPointF(0,0) << QPointF(6,0) << QPointF(6,2) << QPointF(2,2) << QPointF(2,6) << QPointF(0,6);
+    QPolygonF triangle;
+    triangle << QPointF(0,0) << QPointF(3,1) << QPointF(1,3);
+
+    // Each edge of one square is parallel to two of the other: 16 pairs, 8 of them empty.
+    QTest::newRow("squares") << square << square << 8;
+    QTest::newRow("l_shape_triangle") << lShape << triangle << 18;
+    QTest::newRow("triangle_l_shape") << triangle << lShape << 18;
+}
+
+void TestSvgNest::testMinkowskiQuads() {
+    QFETCH(QPolygonF, a);
+    QFETCH(QPolygonF, b);
+    QFETCH(int, quadCount);
+    const double scale = 1000.0;
+    const Clipper2Lib::Path64 pathA = GeometryUtils::toPath64(a, scale);
+    const Clipper2Lib::Path64 pathB = GeometryUtils::toPath64(b, scale);
+
+    std::vector<Clipper2Lib::Point64> quads;
+    Geometry::MinkowskiQuads::append(pathA, pathB, true, quads);
+    QCOMPARE(static_cast<int>(quads.size()), 4 * quadCount);
+    Clipper2Lib::Paths64 paths;
+    Geometry::MinkowskiQuads::appendPaths(quads, paths);
+    for (const Clipper2Lib::Path64& quad : paths) {
+        QVERIFY(Clipper2Lib::Area(quad) > 0);
+    }
+    // Same swept band as Clipper2's MinkowskiSum.
+    const Clipper2Lib::Paths64 expected = Clipper2Lib::MinkowskiSum(pathB, pathA, true);
+    QCOMPARE(Clipper2Lib::Area(Clipper2Lib::Xor(Clipper2Lib::Union(paths, Clipper2Lib::FillRule::NonZero), expected,
+                                                 Clipper2Lib::FillRule::NonZero)), 0.0);
+
+    // The int kernel of the original module: closed rings repeat their first vertex.
+    std::vector<Geometry::MinkowskiQuads::Point32> a32, b32, quads32;
+    for (const Clipper2Lib::Point64& p : pathA) a32.push_back({static_cast<int32_t>(p.x), static_cast<int32_t>(p.y)});
+    for (const Clipper2Lib::Point64& p : pathB) b32.push_back({static_cast<int32_t>(p.x), static_cast<int32_t>(p.y)});
+    a32.push_back(a32.front());
+    b32.push_back(b32.front());
+    Geometry::MinkowskiQuads::append(a32.data(), a32.size(), b32.data(), b32.size(), quads32);
+    QCOMPARE(quads32.size(), quads.size());
+    for (size_t i = 0; i < quads.size(); ++i) {
+        QCOMPARE(static_cast<int64_t>(quads32[i].x), quads[i].x);
+        QCOMPARE(static_cast<int64_t>(quads32[i].y), quads[i].y);
+    }
+}
+
+void TestSvgNest::testBatchPointInPolygon() {
+    using Clipper2Lib::PointInPolygonResult;
+    // A square with a hole, and a second square overlapping its corner (winding 2 there).
+    const Clipper2Lib::Paths64 region = {
+        {{0, 0}, {100, 0}, {100, 100}, {0, 100}},
+        {{40, 40}, {40, 60}, {60, 60}, {60, 40}},
+        {{80, 80}, {120, 80}, {120, 120}, {80, 120}}};
+    const Geometry::BatchPointInPolygon batch(region);
+    QVERIFY(batch.bounds() == Clipper2Lib::Rect64(0, 0, 120, 120));
+
+    const Clipper2Lib::Path64 points = {{10, 10}, {50, 50}, {90, 90}, {-5, 50}, {0, 50}, {40, 40}, {110, 110}, {200, 200}};
+    std::vector<PointInPolygonResult> results;
+    batch.locate(points, Clipper2Lib::FillRule::NonZero, results);
+    QVERIFY(results == (std::vector<PointInPolygonResult>{
+        PointInPolygonResult::IsInside, PointInPolygonResult::IsOutside, PointInPolygonResult::IsInside,
+        PointInPolygonResult::IsOutside, PointInPolygonResult::IsOn, PointInPolygonResult::IsOn,
+        PointInPolygonResult::IsInside, PointInPolygonResult::IsOutside}));
+    batch.locate(points, Clipper2Lib::FillRule::EvenOdd, results);
+    QCOMPARE(results[2], PointInPolygonResult::IsOutside); // Winding 2
+    QCOMPARE(results[6], PointInPolygonResult::IsInside);
+
+    // On the overlapping square's edge but inside the first square: not on the region's boundary.
+    batch.locate(Clipper2Lib::Path64{{80, 90}, {90, 80}, {80, 100}}, Clipper2Lib::FillRule::NonZero, results);
+    QVERIFY(results == (std::vector<PointInPolygonResult>{
+        PointInPolygonResult::IsInside, PointInPolygonResult::IsInside, PointInPolygonResult::IsOn}));
+
+    // Every point of a grid over the bounds (many on edges and vertices) against Clipper2's
+    // PointInPolygon, ring by ring, on the union of the region, whose rings do not overlap.
+    const Clipper2Lib::Paths64 boundary = Clipper2Lib::Union(region, Clipper2Lib::FillRule::NonZero);
+    Clipper2Lib::Path64 grid;
+    for (int64_t y = -10; y <= 130; y += 5) {
+        for (int64_t x = -10; x <= 130; x += 5) grid.push_back(Clipper2Lib::Point64(x, y));
+    }
+    batch.locate(grid, Clipper2Lib::FillRule::NonZero, results);
+    for (size_t i = 0; i < grid.size(); ++i) {
+        int winding = 0;
+        bool on = false;
+        for (const Clipper2Lib::Path64& ring : boundary) {
+            const PointInPolygonResult result = Clipper2Lib::PointInPolygon(grid[i], ring);
+            if (result == PointInPolygonResult::IsOn) on = true;
+            if (result == PointInPolygonResult::IsInside) winding += Clipper2Lib::IsPositive(ring) ? 1 : -1;
+        }
+        const PointInPolygonResult expected = on ? PointInPolygonResult::IsOn
+                                            : winding != 0 ? PointInPolygonResult::IsInside : PointInPolygonResult::IsOutside;
+        QCOMPARE(results[i], expected);
+    }
+}
+
+void TestSvgNest::testMinkowskiBatch() {
+    // Pairs of rectangles and L-shapes of varying sizes; the batch must match one CalculateNfp call per pair.
+    std::vector<CustomMinkowski::NfpTaskItem> tasks;
+    for (int i = 0; i < 24; ++i) {
+        const double size = 1.0 + i % 5;
+        CustomMinkowski::NfpTaskItem task;
+        task.partA.outer = {{0, 0}, {size, 0}, {size, size}, {0, size}};
+        if (i % 2 == 0) {
+            task.partB.outer = {{0, 0}, {4, 0}, {4, 1}, {1, 1}, {1, 4}, {0, 4}};
+        } else {
+            task.partB.outer = {{0, 0}, {2, 0}, {2, 3}, {0, 3}};
+        }
+        task.taskId = 100 + i;
+        tasks.push_back(task);
+    }
+
+    const double scale = 1000.0;
+    for (int threads : {0, 1, 3}) {
+        std::vector<CustomMinkowski::NfpBatchResultItem> results;
+        QVERIFY(CustomMinkowski::CalculateNfp_Batch_MultiThreaded(tasks, results, scale, threads));
+        QCOMPARE(results.size(), tasks.size());
+        for (size_t i = 0; i < tasks.size(); ++i) {
+            CustomMinkowski::NfpResultPolygons expected;
+            const bool success = CustomMinkowski::CalculateNfp(tasks[i].partA, tasks[i].partB, expected, scale);
+            QCOMPARE(results[i].taskId, tasks[i].taskId);
+            QCOMPARE(results[i].success, success);
+            QCOMPARE(results[i].nfp.size(), expected.size());
+            auto expectedPath = expected.begin();
+            for (const CustomMinkowski::PolygonPath& path : results[i].nfp) {
+                QCOMPARE(path.size(), expectedPath->size());
+                for (size_t p = 0; p < path.size(); ++p) {
+                    QCOMPARE(path[p].x, (*expectedPath)[p].x);
+                    QCOMPARE(path[p].y, (*expectedPath)[p].y);
+                }
+                ++expectedPath;
+            }
+        }
+    }
+
+}
+
+void TestSvgNest::testMinkowskiAdaptiveScale() {
+    // A 5000 x 3000 sheet-sized part: 1e7 (the default clipperScale) would overflow int.
+    CustomMinkowski::PolygonWithHoles large;
+    large.outer = {{0, 0}, {5000, 0}, {5000, 3000}, {0, 3000}};
+    CustomMinkowski::PolygonWithHoles small;
+    small.outer = {{0, 0}, {1.25, 0}, {1.25, 0.5}, {0, 0.5}};
+
+    const double scale = CustomMinkowski::AdaptiveScale(large, small);
+    // The sum spans x in [-1.25, 5000], so 5000 is the largest coordinate that has to fit.
+    QVERIFY(scale * 5000.0 <= 0.1 * std::numeric_limits<int>::max() * (1 + 1e-12));
+
+    for (double requestedScale : {0.0, 1e7}) {
+        CustomMinkowski::NfpResultPolygons nfp;
+        QVERIFY(CustomMinkowski::CalculateNfp(large, small, nfp, requestedScale));
+        QCOMPARE(static_cast<int>(nfp.size()), 1);
+        // The static part comes first: NFP of the small rectangle around the large one,
+        // x in [-1.25, 5000] and y in [-0.5, 3000], at the scale's precision.
+        double minX = 1e300, maxX = -1e300, minY = 1e300, maxY = -1e300;
+        for (const CustomMinkowski::Point& p : nfp.front()) {
+            minX = std::min(minX, p.x); maxX = std::max(maxX, p.x);
+            minY = std::min(minY, p.y); maxY = std::max(maxY, p.y);
+        }
+        QVERIFY(qAbs(minX + 1.25) < 1e-4 && qAbs(maxX - 5000) < 1e-4);
+        QVERIFY(qAbs(minY + 0.5) < 1e-4 && qAbs(maxY - 3000) < 1e-4);
+    }
+}
+
+void TestSvgNest::testOriginalModuleNfp_data() {
+    QTest::addColumn<QPolygonF>("orbitingPart");
+    QTest::addColumn<QList<QPolygonF>>("orbitingHoles");
+    QTest::addColumn<QPolygonF>("staticPart");
+    QTest::addColumn<QList<QPolygonF>>("staticHoles");
+
+    // Neither part symmetric nor at the origin, so a reflected or shifted result cannot match.
+    QPolygonF lShape;
+    lShape << QPointF(3,2) << QPointF(9,2) << QPointF(9,4) << QPointF(5,4) << QPointF(5,9) << QPointF(3,9);
+    QPolygonF offsetRectangle;
+    offsetRectangle << QPointF(10,10) << QPointF(14,10) << QPointF(14,12) << QPointF(10,12);
+    QPolygonF notch;
+    notch << QPointF(-2,1) << QPointF(6,1) << QPointF(6,7) << QPointF(4,7) << QPointF(4,3) << QPointF(0,3) << QPointF(0,7) << QPointF(-2,7);
+
+    QTest::newRow("l_around_offset_rectangle") << lShape << QList<QPolygonF>() << offsetRectangle << QList<QPolygonF>();
+    QTest::newRow("notch_around_l") << notch << QList<QPolygonF>() << lShape << QList<QPolygonF>();
+
+    // The L fits in the flange's cutout: the NFP has a hole, whichever of the two parts moves.
+    QPolygonF flange;
+    flange << QPointF(0,0) << QPointF(20,0) << QPointF(20,20) << QPointF(0,20);
+    QPolygonF flangeCutout;
+    flangeCutout << QPointF(5,5) << QPointF(15,5) << QPointF(15,15) << QPointF(5,15);
+    QTest::newRow("l_in_flange_cutout") << lShape << QList<QPolygonF>() << flange << QList<QPolygonF>{flangeCutout};
+    QTest::newRow("flange_around_l") << flange << QList<QPolygonF>{flangeCutout} << lShape << QList<QPolygonF>();
+    QTest::newRow("flange_around_notch") << flange << QList<QPolygonF>{flangeCutout} << notch << QList<QPolygonF>();
+}
+
+void TestSvgNest::testOriginalModuleNfp() {
+    QFETCH(QPolygonF, orbitingPart);
+    QFETCH(QList<QPolygonF>, orbitingHoles);
+    QFETCH(QPolygonF, staticPart);
+    QFETCH(QList<QPolygonF>, staticHoles);
+    const double scale = 1000.0;
+
+    Core::InternalPart orbiting("orbiting", orbitingPart, orbitingHoles);
+    Core::InternalPart obstacle("static", staticPart, staticHoles);
+    orbiting.buildPath64(scale);
+    obstacle.buildPath64(scale);
+
+    // The Boost.Polygon module, alone and batched, gives the region minkowskiNfp (Clipper2) gives,
+    // up to the rounding of its own integer scale.
+    Geometry::NfpGenerator generator(scale);
+    const Clipper2Lib::Paths64 expected = generator.calculateNfp(orbiting, obstacle, Geometry::NfpBackend::Clipper2, false);
+    const Clipper2Lib::Paths64 module = generator.calculateNfp(orbiting, obstacle, Geometry::NfpBackend::CustomMinkowski, false);
+    const QVector<Clipper2Lib::Paths64> batch = generator.calculateNfpBatch(
+        QVector<Geometry::NfpPair>{{&orbiting, &obstacle}, {&orbiting, &obstacle}}, Geometry::NfpBackend::CustomMinkowski);
+    QVERIFY(!expected.empty());
+    auto holeCount = [](const Clipper2Lib::Paths64& paths) {
+        return static_cast<int>(std::count_if(paths.begin(), paths.end(),
+                                              [](const Clipper2Lib::Path64& path) { return !Clipper2Lib::IsPositive(path); }));
+    };
+    QCOMPARE(holeCount(expected), static_cast<int>(staticHoles.size() + orbitingHoles.size()));
+    for (const Clipper2Lib::Paths64& nfp : {module, batch[0], batch[1]}) {
+        QVERIFY(!nfp.empty());
+        QCOMPARE(holeCount(nfp), holeCount(expected));
+        QVERIFY(qAbs(Clipper2Lib::Area(nfp) - Clipper2Lib::Area(expected)) / (scale * scale) < 1e-3);
+        QVERIFY(Clipper2Lib::Area(Clipper2Lib::Xor(nfp, expected, Clipper2Lib::FillRule::NonZero)) / (scale * scale) < 1e-3);
+    }
+}
+
 void TestSvgNest::testNfpCache_data() {
-    QTest::addColumn<QString>("key1");
+    QTest::addColumn<int>("shards");
+    QTest::addColumn<int>("partA");
+    QTest::addColumn<int>("partB");
+    QTest::addColumn<double>("rotation");
     QTest::addColumn<QList<QPolygonF>>("nfp1_polys");
-    QTest::addColumn<QString>("key2");
 
     QList<QPolygonF> nfpData1;
     QPolygonF poly1;
     poly1 << QPointF(0,0) << QPointF(1,0) << QPointF(0,1);
     nfpData1.append(poly1);
 
-    QTest::newRow("cache_ops") << "keyA" << nfpData1 << "keyB";
+    QTest::newRow("cache_ops") << 1 << 0 << 1 << 90.0 << nfpData1;
+    QTest::newRow("cache_ops_fractional_rotation") << 1 << 3 << 7 << 22.5 << nfpData1;
+    QTest::newRow("cache_ops_sharded") << 16 << 0 << 1 << 90.0 << nfpData1;
 }
 
 void TestSvgNest::testNfpCache() {
-    QFETCH(QString, key1);
+    QFETCH(int, shards);
+    QFETCH(int, partA);
+    QFETCH(int, partB);
+    QFETCH(double, rotation);
     QFETCH(QList<QPolygonF>, nfp1_polys);
-    QFETCH(QString, key2);
 
-    Geometry::NfpCache cache;
+    Geometry::NfpCache cache(shards);
+    QCOMPARE(cache.shardCount(), shards);
     QCOMPARE(cache.size(), 0);
 
-    Geometry::CachedNfp nfp1_write(nfp1_polys);
+    Geometry::NfpKey key1 = Geometry::NfpCache::generateKey(partA, rotation, false, partB, 0.0, false, false);
+    const Clipper2Lib::Paths64 nfp1_paths = GeometryUtils::toPaths64(nfp1_polys, 1000.0);
+    Geometry::CachedNfp nfp1_write(nfp1_paths);
     nfp1_write.isValid = true; // Mark as valid for testing findNfp
-    cache.storeNfp(key1, nfp1_write);
+    Geometry::NfpHandle stored = cache.storeNfp(key1, nfp1_write);
     QCOMPARE(cache.size(), 1);
 
-    Geometry::CachedNfp nfp1_read;
-    QVERIFY(cache.findNfp(key1, nfp1_read));
-    QCOMPARE(nfp1_read.nfpPolygons, nfp1_polys);
-    QVERIFY(nfp1_read.isValid);
+    // Equivalent rotations (e.g. -270 == 90) must map to the same key.
+    Geometry::NfpKey sameKey = Geometry::NfpCache::generateKey(partA, rotation - 360.0, false, partB, 360.0, false, false);
+    QVERIFY(sameKey == key1);
 
-    Geometry::CachedNfp nfp2_read;
-    QVERIFY(!cache.findNfp(key2, nfp2_read)); // Key2 not in cache
+    Geometry::NfpHandle nfp1_read = cache.findNfp(sameKey);
+    QVERIFY(!nfp1_read.isNull());
+    QVERIFY(nfp1_read == stored); // Lookups share the stored entry instead of copying it
+    QVERIFY(nfp1_read->paths == nfp1_paths);
+    QVERIFY(nfp1_read->isValid);
 
-    QString generatedKey = Geometry::NfpCache::generateKey("partA", 0.0, false, "partB", 90.0, true, false);
-    QVERIFY(!generatedKey.isEmpty());
-    // Example: "partA_0.0000_fvs_partB_90.0000_t_Bstatic"
-    qDebug() << "Generated NfpCache Key:" << generatedKey;
+    // Swapped parts and the inside/outside context are distinct entries.
+    QVERIFY(cache.findNfp(Geometry::NfpCache::generateKey(partB, 0.0, false, partA, rotation, false, false)).isNull());
+    QVERIFY(cache.findNfp(Geometry::NfpCache::generateKey(partA, rotation, false, partB, 0.0, false, true)).isNull());
+
+    // Invalid entries are stored but never handed out.
+    Geometry::NfpKey invalidKey = Geometry::NfpCache::generateKey(partA, 0.0, true, partB, 0.0, true, false);
+    cache.storeNfp(invalidKey, Geometry::CachedNfp());
+    QVERIFY(cache.findNfp(invalidKey).isNull());
+
+    // Enough entries to force the open-addressing tables to grow.
+    for (int i = 0; i < 1000; ++i) {
+        cache.storeNfp(Geometry::NfpCache::generateKey(i, 0.0, false, i + 1, 0.0, false, true), nfp1_write);
+    }
+    QCOMPARE(cache.size(), 1002);
+    QVERIFY(!cache.findNfp(key1).isNull());
+    QVERIFY(!cache.findNfp(Geometry::NfpCache::generateKey(500, 0.0, false, 501, 0.0, false, true)).isNull());
 
     cache.clear();
     QCOMPARE(cache.size(), 0);
+    QVERIFY(cache.findNfp(key1).isNull());
+    QVERIFY(stored->paths == nfp1_paths); // Handles outlive the cache entry
+}
+
+void TestSvgNest::testNfpCacheEviction() {
+    const Clipper2Lib::Path64 square = {{0,0}, {10,0}, {10,10}, {0,10}};
+    Geometry::CachedNfp entry(Clipper2Lib::Paths64{square});
+    const qint64 cost = Geometry::NfpCache::entryCost(entry);
+    QVERIFY(cost > 4 * static_cast<qint64>(sizeof(Clipper2Lib::Point64)));
+
+    // Room for ten entries in a single shard.
+    Geometry::NfpCache cache(1, 10 * cost);
+    Geometry::NfpKey innerKey = Geometry::NfpCache::generateKey(0, 0.0, false, 1, 0.0, false, true);
+    cache.storeNfp(innerKey, entry);
+
+    for (int i = 0; i < 100; ++i) {
+        cache.storeNfp(Geometry::NfpCache::generateKey(i + 2, 0.0, false, 1, 0.0, false, false), entry);
+        QVERIFY(!cache.findNfp(innerKey).isNull()); // The hot inner NFP stays resident
+        QVERIFY(cache.memoryUsage() <= 10 * cost);
+    }
+    QCOMPARE(cache.size(), 10);
+    QCOMPARE(cache.memoryUsage(), 10 * cost);
+
+    // The most recent insertion is still there, the oldest outer entries were evicted.
+    QVERIFY(!cache.findNfp(Geometry::NfpCache::generateKey(101, 0.0, false, 1, 0.0, false, false)).isNull());
+    QVERIFY(cache.findNfp(Geometry::NfpCache::generateKey(2, 0.0, false, 1, 0.0, false, false)).isNull());
+
+    // Without a budget nothing is evicted.
+    Geometry::NfpCache unbounded(1, 0);
+    for (int i = 0; i < 100; ++i) {
+        unbounded.storeNfp(Geometry::NfpCache::generateKey(i, 0.0, false, 1, 0.0, false, false), entry);
+    }
+    QCOMPARE(unbounded.size(), 100);
+    QCOMPARE(unbounded.memoryUsage(), 100 * cost);
+}
+
+void TestSvgNest::testNfpStats() {
+    const Clipper2Lib::Path64 square = {{0,0}, {10,0}, {10,10}, {0,10}};
+    Geometry::CachedNfp entry(Clipper2Lib::Paths64{square});
+    const qint64 cost = Geometry::NfpCache::entryCost(entry);
+
+    Geometry::NfpCache cache(1, 2 * cost);
+    const Geometry::NfpKey outerKey = Geometry::NfpCache::generateKey(0, 0.0, false, 1, 0.0, false, false);
+    const Geometry::NfpKey innerKey = Geometry::NfpCache::generateKey(0, 0.0, false, 1, 0.0, false, true);
+
+    QVERIFY(cache.findNfp(outerKey).isNull());
+    cache.storeNfp(outerKey, entry);
+    QVERIFY(!cache.findNfp(outerKey).isNull());
+    QVERIFY(!cache.findNfp(outerKey).isNull());
+    QVERIFY(cache.findNfp(innerKey).isNull());
+    QVERIFY(cache.contains(outerKey)); // Not counted as a lookup
+
+    const Geometry::NfpStats& stats = cache.stats();
+    QCOMPARE(stats.hits(Geometry::NfpKind::Outer), quint64(2));
+    QCOMPARE(stats.misses(Geometry::NfpKind::Outer), quint64(1));
+    QCOMPARE(stats.misses(Geometry::NfpKind::Inner), quint64(1));
+    QCOMPARE(stats.evictions(), quint64(0));
+
+    // Two more entries overflow the two-entry budget.
+    cache.storeNfp(innerKey, entry);
+    cache.storeNfp(Geometry::NfpCache::generateKey(2, 0.0, false, 1, 0.0, false, false), entry);
+    QCOMPARE(stats.evictions(), quint64(1));
+
+    cache.stats().latency(Geometry::NfpBackend::Clipper2, Geometry::NfpKind::Outer).record(1500);   // 1.5 us
+    cache.stats().latency(Geometry::NfpBackend::Clipper2, Geometry::NfpKind::Outer).record(300000); // 300 us
+
+    const QJsonObject json = cache.statisticsJson();
+    QCOMPARE(json["entries"].toInt(), 2);
+    QCOMPARE(json["bytes"].toDouble(), static_cast<double>(2 * cost));
+    QCOMPARE(json["evictions"].toDouble(), 1.0);
+    QCOMPARE(json["outer"].toObject()["hits"].toDouble(), 2.0);
+    const QJsonObject latency = json["latency"].toObject();
+    QVERIFY(!latency.contains("customMinkowski")); // No samples, omitted
+    const QJsonObject clipperOuter = latency["clipper2"].toObject()["outer"].toObject();
+    QCOMPARE(clipperOuter["count"].toDouble(), 2.0);
+    QCOMPARE(clipperOuter["maxUs"].toDouble(), 300.0);
+    QCOMPARE(clipperOuter["p50Us"].toDouble(), 2.0);   // 1.5 us falls in [1, 2)
+    QCOMPARE(clipperOuter["p99Us"].toDouble(), 512.0); // 300 us falls in [256, 512)
+}
+
+void TestSvgNest::testNfpCacheSingleFlight() {
+    const Clipper2Lib::Path64 square = {{0,0}, {10,0}, {10,10}, {0,10}};
+    Geometry::NfpCache cache(4);
+    const Geometry::NfpKey key = Geometry::NfpCache::generateKey(0, 0.0, false, 1, 0.0, false, false);
+
+    QAtomicInt computations(0);
+    auto compute = [&]() {
+        computations.fetchAndAddRelaxed(1);
+        QThread::msleep(50); // Long enough for every thread to miss while it runs
+        return Geometry::CachedNfp(Clipper2Lib::Paths64{square});
+    };
+
+    const int threads = 8;
+    QList<QFuture<Geometry::NfpHandle>> futures;
+    for (int i = 0; i < threads; ++i) {
+        futures.append(QtConcurrent::run([&]() { return cache.getOrCompute(key, compute); }));
+    }
+    QList<Geometry::NfpHandle> handles;
+    for (QFuture<Geometry::NfpHandle>& future : futures) {
+        handles.append(future.result());
+    }
+
+    QCOMPARE(computations.loadRelaxed(), 1);
+    for (const Geometry::NfpHandle& handle : handles) {
+        QVERIFY(!handle.isNull());
+        QCOMPARE(handle.data(), handles.first().data()); // Everyone shares the one result
+    }
+    QCOMPARE(cache.size(), 1);
+    QCOMPARE(cache.findNfp(key).data(), handles.first().data());
+
+    // A failing computation releases the key; the next caller computes it again.
+    const Geometry::NfpKey failingKey = Geometry::NfpCache::generateKey(2, 0.0, false, 1, 0.0, false, false);
+    bool thrown = false;
+    try {
+        cache.getOrCompute(failingKey, []() -> Geometry::CachedNfp { throw std::runtime_error("nfp failed"); });
+    } catch (const std::runtime_error&) {
+        thrown = true;
+    }
+    QVERIFY(thrown);
+    QVERIFY(cache.findNfp(failingKey).isNull());
+    QVERIFY(!cache.getOrCompute(failingKey, compute).isNull());
+    QCOMPARE(computations.loadRelaxed(), 2);
+}
+
+void TestSvgNest::testNfpView() {
+    const Clipper2Lib::Path64 nfp = {{1000,0}, {4000,0}, {4000,2000}, {1000,3000}};
+    Geometry::NfpHandle handle(new Geometry::CachedNfp(Clipper2Lib::Paths64{nfp}));
+
+    // Translation only: the view matches a translated copy.
+    Geometry::NfpView translated(handle, Clipper2Lib::Point64(10000, 20000));
+    QVERIFY(translated.path(0) == Clipper2Lib::TranslatePath(nfp, 10000, 20000));
+    QVERIFY(translated.toLocal(Clipper2Lib::Point64(11000, 20000)) == Clipper2Lib::Point64(1000, 0));
+
+    // Quarter turns are exact in integer coordinates and follow QTransform::rotate.
+    for (double rotation : {90.0, 180.0, 270.0, -90.0}) {
+        Geometry::NfpView view(handle, Clipper2Lib::Point64(5000, -5000), rotation);
+        QTransform t;
+        t.translate(5000, -5000);
+        t.rotate(rotation);
+        const Clipper2Lib::Path64 viewPath = view.path(0);
+        for (size_t i = 0; i < nfp.size(); ++i) {
+            const QPointF expected = t.map(QPointF(nfp[i].x, nfp[i].y));
+            QVERIFY(viewPath[i] == Clipper2Lib::Point64(qRound64(expected.x()), qRound64(expected.y())));
+            QVERIFY(view.toLocal(viewPath[i]) == nfp[i]);
+        }
+    }
+
+    // Other angles round-trip within one unit of the fixed-point grid.
+    Geometry::NfpView oblique(handle, Clipper2Lib::Point64(3000, 4000), 22.5);
+    const Clipper2Lib::Path64 obliquePath = oblique.path(0);
+    for (size_t i = 0; i < nfp.size(); ++i) {
+        const Clipper2Lib::Point64 back = oblique.toLocal(obliquePath[i]);
+        QVERIFY(std::abs(back.x - nfp[i].x) <= 1);
+        QVERIFY(std::abs(back.y - nfp[i].y) <= 1);
+    }
+}
+
+void TestSvgNest::testNfpViewTranslation() {
+    // NFPs are cached with the static part (or container) at the origin. Seen through a view at
+    // an obstacle's position, a cached NFP must cover the same region as one computed afresh
+    // against the part placed there, for outer and inner keys alike.
+    const double scale = 1000.0;
+    QPolygonF triangle;
+    triangle << QPointF(0,0) << QPointF(2,0) << QPointF(0,2);
+    QPolygonF frame;
+    frame << QPointF(0,0) << QPointF(10,0) << QPointF(10,10) << QPointF(0,10);
+    QPolygonF frameHole;
+    frameHole << QPointF(3,3) << QPointF(7,3) << QPointF(7,7) << QPointF(3,7);
+    QPolygonF sheet;
+    sheet << QPointF(0,0) << QPointF(20,0) << QPointF(20,20) << QPointF(0,20);
+    QPolygonF sheetHole;
+    sheetHole << QPointF(8,8) << QPointF(12,8) << QPointF(12,12) << QPointF(8,12);
+    Core::InternalPart moving("moving", triangle);
+    Core::InternalPart obstacle("obstacle", frame, QList<QPolygonF>() << frameHole);
+    Core::InternalPart container("sheet", sheet, QList<QPolygonF>() << sheetHole);
+    for (Core::InternalPart* part : {&moving, &obstacle, &container}) part->buildPath64(scale);
+
+    auto translated = [](Core::InternalPart part, const Clipper2Lib::Point64& offset) {
+        part.outerPath64 = Clipper2Lib::TranslatePath(part.outerPath64, offset.x, offset.y);
+        part.holesPath64 = Clipper2Lib::TranslatePaths(part.holesPath64, offset.x, offset.y);
+        return part;
+    };
+    auto viewPaths = [](const Geometry::NfpView& view) {
+        Clipper2Lib::Paths64 paths;
+        for (size_t i = 0; i < view.nfp->paths.size(); ++i) paths.push_back(view.path(i));
+        return paths;
+    };
+    auto sameRegion = [](const Clipper2Lib::Paths64& a, const Clipper2Lib::Paths64& b) {
+        const double difference = Clipper2Lib::Area(Clipper2Lib::Xor(a, b, Clipper2Lib::FillRule::NonZero));
+        return qAbs(Clipper2Lib::Area(a) - Clipper2Lib::Area(b)) <= 1e-9 * qAbs(Clipper2Lib::Area(b)) + 1.0 &&
+               qAbs(difference) <= 1e-9 * qAbs(Clipper2Lib::Area(b)) + 1.0;
+    };
+
+    Geometry::NfpGenerator generator(scale);
+    Geometry::NfpCache cache;
+    int computations = 0;
+    const Geometry::NfpKey outerKey = Geometry::NfpCache::generateKey(0, 0.0, false, 1, 0.0, false, false);
+    const Geometry::NfpKey innerKey = Geometry::NfpCache::generateKey(0, 0.0, false, 2, 0.0, false, true);
+    auto outerAtOrigin = [&]() {
+        ++computations;
+        return Geometry::CachedNfp(generator.calculateNfp(moving, obstacle, Geometry::NfpBackend::Clipper2, false));
+    };
+    auto innerAtOrigin = [&]() {
+        ++computations;
+        return Geometry::CachedNfp(generator.calculateNfpInside(moving, container, Geometry::NfpBackend::Clipper2, false));
+    };
+
+    const QList<Clipper2Lib::Point64> positions = {Clipper2Lib::Point64(25000, -5000), Clipper2Lib::Point64(-13500, 40250)};
+    for (const Clipper2Lib::Point64& position : positions) {
+        const Geometry::NfpView outer(cache.getOrCompute(outerKey, outerAtOrigin), position);
+        QVERIFY(outer.nfp->paths.size() >= 2); // The triangle fits in the frame's hole
+        QVERIFY(sameRegion(viewPaths(outer),
+                           generator.calculateNfp(moving, translated(obstacle, position), Geometry::NfpBackend::Clipper2, false)));
+
+        const Geometry::NfpView inner(cache.getOrCompute(innerKey, innerAtOrigin), position);
+        QVERIFY(inner.nfp->paths.size() >= 2); // The sheet's hole is a hole of the inner NFP
+        QVERIFY(sameRegion(viewPaths(inner),
+                           generator.calculateNfpInside(moving, translated(container, position), Geometry::NfpBackend::Clipper2, false)));
+    }
+    QCOMPARE(computations, 2); // Each key computed once, at the origin, and hit for the second position
+}
+
+void TestSvgNest::testFeasibleRegion() {
+    const Clipper2Lib::Path64 sheetRing = {{0,0}, {100,0}, {100,100}, {0,100}};
+    Geometry::NfpHandle inner(new Geometry::CachedNfp(Clipper2Lib::Paths64{sheetRing}));
+    // Two obstacle NFPs that overlap each other: x 40..60, y -10..50 and x 50..80, y 40..80.
+    const Clipper2Lib::Paths64 obstacles = {{{40,-10}, {60,-10}, {60,50}, {40,50}},
+                                            {{50,40}, {80,40}, {80,80}, {50,80}}};
+
+    Core::FeasibleRegion stage;
+    stage.setContainer(inner);
+    stage.compute(Clipper2Lib::Paths64());
+    QVERIFY(stage.region() == inner->paths);
+    QVERIFY(stage.segments().empty());
+
+    // The union of the obstacles is subtracted once: 10000 - (1200 + 1200 - 100).
+    stage.compute(obstacles);
+    QCOMPARE(Clipper2Lib::Area(stage.region()), 7900.0);
+    QVERIFY(stage.segments().empty());
+    stage.compute(Clipper2Lib::Union(obstacles, Clipper2Lib::FillRule::NonZero));
+    QCOMPARE(Clipper2Lib::Area(stage.region()), 7900.0);
+    auto hasVertex = [](const Clipper2Lib::Paths64& paths, const Clipper2Lib::Point64& point) {
+        for (const Clipper2Lib::Path64& path : paths) {
+            if (std::find(path.begin(), path.end(), point) != path.end()) return true;
+        }
+        return false;
+    };
+    // Touching the sheet edge and either side of the first obstacle.
+    QVERIFY(hasVertex(stage.region(), Clipper2Lib::Point64(40, 0)));
+    QVERIFY(hasVertex(stage.region(), Clipper2Lib::Point64(60, 0)));
+
+    // A part exactly as tall as the sheet: the positions form a segment, split by the obstacle.
+    Geometry::NfpHandle strip(new Geometry::CachedNfp(Clipper2Lib::Paths64{{{0,0}, {100,0}, {100,0}, {0,0}}}));
+    stage.setContainer(strip);
+    stage.compute(obstacles);
+    QVERIFY(stage.region().empty());
+    QCOMPARE(static_cast<int>(stage.segments().size()), 2);
+    QVERIFY(hasVertex(stage.segments(), Clipper2Lib::Point64(40, 0)));
+    QVERIFY(hasVertex(stage.segments(), Clipper2Lib::Point64(60, 0)));
+
+    // An exact fit in both directions is one position, kept unless an obstacle NFP covers it
+    // (the obstacles overlap, so this needs their winding number rather than even-odd parity).
+    Geometry::NfpHandle freePoint(new Geometry::CachedNfp(Clipper2Lib::Paths64{{{70,0}, {70,0}, {70,0}, {70,0}}}));
+    stage.setContainer(freePoint);
+    stage.compute(obstacles);
+    QCOMPARE(static_cast<int>(stage.segments().size()), 1);
+    QVERIFY(stage.segments().front() == Clipper2Lib::Path64{Clipper2Lib::Point64(70, 0)});
+    Geometry::NfpHandle coveredPoint(new Geometry::CachedNfp(Clipper2Lib::Paths64{{{55,45}, {55,45}, {55,45}, {55,45}}}));
+    stage.setContainer(coveredPoint);
+    stage.compute(obstacles);
+    QVERIFY(stage.segments().empty());
+    // On the second obstacle's edge but inside the first: covered, not touching.
+    Geometry::NfpHandle edgePoint(new Geometry::CachedNfp(Clipper2Lib::Paths64{{{50,45}, {50,45}, {50,45}, {50,45}}}));
+    stage.setContainer(edgePoint);
+    stage.compute(obstacles);
+    QVERIFY(stage.segments().empty());
+    // On the boundary of the union, where the part touches both obstacles: feasible.
+    Geometry::NfpHandle cornerPoint(new Geometry::CachedNfp(Clipper2Lib::Paths64{{{60,40}, {60,40}, {60,40}, {60,40}}}));
+    stage.setContainer(cornerPoint);
+    stage.compute(obstacles);
+    QCOMPARE(static_cast<int>(stage.segments().size()), 1);
+}
+
+void TestSvgNest::testPlacementTrie() {
+    QVector<Core::Gene> chromosome;
+    for (int i = 0; i < 5; ++i) chromosome.append(Core::Gene(QString("P%1").arg(i), i, 90.0 * i));
+    auto stateWith = [](int placements) {
+        Core::PlacementState* state = new Core::PlacementState;
+        for (int i = 0; i < placements; ++i) state->placements.append({QString("P%1").arg(i), 0, QPointF(i, 0), 0.0});
+        return Core::PlacementStateHandle(state);
+    };
+
+    Core::PlacementTrie trie;
+    trie.beginGeneration(0);
+    trie.insert(chromosome, 2, stateWith(2));
+    trie.insert(chromosome, 4, stateWith(4));
+    QCOMPARE(trie.stateCount(), 2);
+
+    Core::PlacementStateHandle state;
+    QCOMPARE(trie.findLongestPrefix(chromosome, state), 4);
+    QCOMPARE(state->placements.size(), 4);
+
+    // Same first two genes, then another rotation of the third part.
+    QVector<Core::Gene> sibling = chromosome;
+    sibling[2].rotation = 0.0;
+    QCOMPARE(trie.findLongestPrefix(sibling, state), 2);
+    QCOMPARE(state->placements.size(), 2);
+
+    QVector<Core::Gene> stranger = chromosome;
+    stranger[0].rotation = 270.0;
+    QCOMPARE(trie.findLongestPrefix(stranger, state), 0);
+    QVERIFY(state.isNull());
+
+    // Only the prefix reached in generation 1 survives into generation 2.
+    trie.beginGeneration(1);
+    QCOMPARE(trie.stateCount(), 2);
+    QCOMPARE(trie.findLongestPrefix(sibling, state), 2);
+    trie.beginGeneration(2);
+    QCOMPARE(trie.stateCount(), 1);
+    QCOMPARE(trie.findLongestPrefix(chromosome, state), 2);
+
+    trie.clear();
+    QCOMPARE(trie.stateCount(), 0);
+    QCOMPARE(trie.memoryUsage(), qint64(0));
+    QCOMPARE(trie.findLongestPrefix(chromosome, state), 0);
+
+    // Obstacles refer to the parts instead of copying them, and the states stay within the budget.
+    Core::InternalPart part;
+    part.outerPath64 = {{0, 0}, {100, 0}, {100, 100}, {0, 100}};
+    Core::PlacementState placed = *stateWith(2);
+    placed.sheets[0].obstacles.append({&part, 0.0, Clipper2Lib::Point64(0, 0)});
+    const Core::PlacementStateHandle withObstacle(new Core::PlacementState(placed));
+    const qint64 twoBytes = Core::PlacementTrie::stateBytes(*withObstacle);
+    const qint64 fourBytes = Core::PlacementTrie::stateBytes(*stateWith(4));
+
+    Core::PlacementTrie bounded(twoBytes + fourBytes - 1);
+    bounded.beginGeneration(0);
+    QVERIFY(bounded.insert(chromosome, 2, withObstacle));
+    QVERIFY(!bounded.insert(chromosome, 4, stateWith(4)));
+    QCOMPARE(bounded.stateCount(), 1);
+    QCOMPARE(bounded.memoryUsage(), twoBytes);
+    QCOMPARE(bounded.findLongestPrefix(chromosome, state), 2);
+    QCOMPARE(state->sheets[0].obstacles.first().part, &part);
+
+    // Pruning frees room for new checkpoints.
+    bounded.beginGeneration(1);
+    bounded.beginGeneration(2);
+    QCOMPARE(bounded.memoryUsage(), qint64(0));
+    QVERIFY(bounded.insert(chromosome, 4, stateWith(4)));
+    QCOMPARE(bounded.memoryUsage(), fourBytes);
+}
+
+void TestSvgNest::testObstacleUnion() {
+    // Square NFPs of a grid of obstacles, some overlapping into clusters, one ring around a gap.
+    QList<Clipper2Lib::Paths64> nfps;
+    auto square = [](int64_t x, int64_t y, int64_t size) {
+        return Clipper2Lib::Paths64{{{x, y}, {x + size, y}, {x + size, y + size}, {x, y + size}}};
+    };
+    for (int i = 0; i < 6; ++i) nfps.append(square(100 * i, 0, 60));   // Separate
+    for (int i = 0; i < 6; ++i) nfps.append(square(40 * i, 200, 60));  // One chain
+    nfps.append(square(1000, 1000, 100));                              // Ring around a 20x20 gap:
+    nfps.append(square(1120, 1000, 100));
+    nfps.append(square(1000, 1120, 100));
+    nfps.append(square(1120, 1120, 100));
+    nfps.append(Clipper2Lib::Paths64{{{1050, 1050}, {1170, 1050}, {1170, 1100}, {1050, 1100}}});
+    nfps.append(Clipper2Lib::Paths64{{{1050, 1120}, {1170, 1120}, {1170, 1170}, {1050, 1170}}});
+    nfps.append(Clipper2Lib::Paths64{{{1050, 1050}, {1100, 1050}, {1100, 1170}, {1050, 1170}}});
+    nfps.append(Clipper2Lib::Paths64{{{1120, 1050}, {1170, 1050}, {1170, 1170}, {1120, 1170}}});
+    nfps.append(square(1105, 1105, 10)); // Island in the gap
+
+    Core::ObstacleUnion obstacleUnion;
+    Clipper2Lib::Paths64 all;
+    for (int i = 0; i < nfps.size(); ++i) {
+        obstacleUnion.add(nfps[i]);
+        all.insert(all.end(), nfps[i].begin(), nfps[i].end());
+        if (i == 1) {
+            // Cells of 60: the first square fills cell (0, 0), the second crosses into cell (2, 0).
+            QCOMPARE(obstacleUnion.cellSize(), int64_t(60));
+            QCOMPARE(obstacleUnion.tileCount(), 3);
+        }
+    }
+    // Axis-aligned squares are cut at the cell edges without rounding, so the tiles cover
+    // exactly the union, with the ring's gap left open and the island inside it.
+    const Clipper2Lib::Paths64 expected = Clipper2Lib::Union(all, Clipper2Lib::FillRule::NonZero);
+    QCOMPARE(Clipper2Lib::Area(Clipper2Lib::Xor(obstacleUnion.paths(), expected, Clipper2Lib::FillRule::NonZero)), 0.0);
+    QCOMPARE(Clipper2Lib::Area(obstacleUnion.paths()), Clipper2Lib::Area(expected));
+
+    // Cells sized from a 1000 x 1000 sheet: a large obstacle after a small one meets at most a
+    // bounded number of cells. Without the sheet the first (small) NFP sizes the cells; a large
+    // NFP would then span thousands of them, so the union becomes a single tile instead.
+    for (bool withSheet : {true, false}) {
+        Core::ObstacleUnion sized;
+        if (withSheet) {
+            sized.setArea(Clipper2Lib::Rect64(0, 0, 1000, 1000));
+            QCOMPARE(sized.cellSize(), int64_t(1000 / Core::ObstacleUnion::kCellsPerSide));
+        }
+        const Clipper2Lib::Paths64 small = square(100, 100, 10), large = square(50, 50, 800);
+        sized.add(small);
+        sized.add(large);
+        QVERIFY(sized.tileCount() <= (withSheet ? Core::ObstacleUnion::kMaxCellsPerAdd : 1));
+        const Clipper2Lib::Paths64 both = Clipper2Lib::Union(small, large, Clipper2Lib::FillRule::NonZero);
+        QCOMPARE(Clipper2Lib::Area(Clipper2Lib::Xor(sized.paths(), both, Clipper2Lib::FillRule::NonZero)), 0.0);
+        sized.add(square(2000, 2000, 10)); // Extends the single tile too
+        QCOMPARE(Clipper2Lib::Area(sized.paths()), Clipper2Lib::Area(both) + 100.0);
+    }
+
+    // One NFP around the origin is cut into four tiles meeting along x = 0 and y = 0. Positions on
+    // those seams are inside the union, not touching it: a part exactly the size of the sheet,
+    // whose only position is the origin, must not be placed on top of the obstacle.
+    Core::ObstacleUnion seamUnion;
+    seamUnion.add(square(-50, -50, 100));
+    QCOMPARE(seamUnion.tileCount(), 4);
+    std::vector<Clipper2Lib::PointInPolygonResult> results;
+    Geometry::BatchPointInPolygon(seamUnion.paths()).locate(Clipper2Lib::Path64{{0, 0}, {10, 0}, {0, -30}, {50, 0}, {0, -50}},
+                                                            Clipper2Lib::FillRule::NonZero, results);
+    QVERIFY(results == (std::vector<Clipper2Lib::PointInPolygonResult>{
+        Clipper2Lib::PointInPolygonResult::IsInside, Clipper2Lib::PointInPolygonResult::IsInside,
+        Clipper2Lib::PointInPolygonResult::IsInside, Clipper2Lib::PointInPolygonResult::IsOn,
+        Clipper2Lib::PointInPolygonResult::IsOn}));
+    Core::FeasibleRegion stage;
+    stage.setContainer(Geometry::NfpHandle(new Geometry::CachedNfp(Clipper2Lib::Paths64{{{0, 0}, {0, 0}, {0, 0}, {0, 0}}})));
+    stage.compute(seamUnion.paths());
+    QVERIFY(stage.segments().empty());
+    stage.setContainer(Geometry::NfpHandle(new Geometry::CachedNfp(Clipper2Lib::Paths64{{{50, 0}, {50, 0}, {50, 0}, {50, 0}}})));
+    stage.compute(seamUnion.paths());
+    QCOMPARE(static_cast<int>(stage.segments().size()), 1);
+}
+
+void TestSvgNest::testNfpDiskStore() {
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+
+    QPolygonF outerPolygon;
+    outerPolygon << QPointF(-1.5,0) << QPointF(10,0) << QPointF(10,10.25) << QPointF(0,10);
+    QPolygonF holePolygon;
+    holePolygon << QPointF(2,2) << QPointF(4,2) << QPointF(3,4);
+    const quint64 shapeA = GeometryUtils::geometryFingerprint(holePolygon, QList<QPolygonF>());
+    const quint64 shapeB = GeometryUtils::geometryFingerprint(outerPolygon, QList<QPolygonF>());
+    const double scale = 10000.0;
+    const Clipper2Lib::Path64 nfpOuter = GeometryUtils::toPath64(outerPolygon, scale);
+    const Clipper2Lib::Path64 nfpHole = GeometryUtils::toPath64(holePolygon, scale);
+    QVERIFY(shapeA != shapeB);
+
+    const Geometry::NfpKey key = Geometry::NfpCache::generateKey(0, 90.0, false, 1, 0.0, false, false);
+    const Geometry::NfpDiskKey diskKey = Geometry::NfpDiskKey::fromKey(key, shapeA, shapeB);
+    // Interned indices are per run, the disk key only depends on the geometry.
+    QVERIFY(Geometry::NfpDiskKey::fromKey(Geometry::NfpCache::generateKey(7, 90.0, false, 3, 0.0, false, false),
+                                          shapeA, shapeB) == diskKey);
+
+    {
+        Geometry::NfpDiskStore writer(dir.path(), 1, scale);
+        QVERIFY(writer.isEnabled());
+        Geometry::NfpDiskEntry missing;
+        QVERIFY(!writer.find(diskKey, missing));
+        writer.record(diskKey, Geometry::NfpHandle(new Geometry::CachedNfp(Clipper2Lib::Paths64{nfpOuter, nfpHole})));
+        writer.record(Geometry::NfpDiskKey::fromKey(key, shapeB, shapeA),
+                      Geometry::NfpHandle(new Geometry::CachedNfp(Clipper2Lib::Paths64{nfpHole})));
+        // An empty NFP is a failed computation and never stored.
+        writer.record(Geometry::NfpDiskKey::fromKey(Geometry::NfpCache::generateKey(0, 270.0, false, 1, 0.0, false, false),
+                                                    shapeA, shapeB),
+                      Geometry::NfpHandle(new Geometry::CachedNfp(Clipper2Lib::Paths64())));
+        QVERIFY(writer.flush());
+        QVERIFY(writer.flush()); // Nothing pending, no new segment
+    }
+
+    // A second store (as another run or process would) maps the segment and finds both entries.
+    Geometry::NfpDiskStore reader(dir.path(), 1, scale);
+    QCOMPARE(reader.segmentCount(), 1);
+    Geometry::NfpDiskEntry loaded;
+    QVERIFY(reader.find(diskKey, loaded));
+    QCOMPARE(loaded.pathCount(), 2);
+    QCOMPARE(loaded.vertexCount(0), nfpOuter.size());
+    QVERIFY(std::equal(nfpOuter.begin(), nfpOuter.end(), loaded.vertices(0))); // Read in place
+    QVERIFY(loaded.toPaths() == (Clipper2Lib::Paths64{nfpOuter, nfpHole}));
+    QVERIFY(reader.find(Geometry::NfpDiskKey::fromKey(key, shapeB, shapeA), loaded));
+    QCOMPARE(loaded.pathCount(), 1);
+    QVERIFY(!reader.find(Geometry::NfpDiskKey::fromKey(
+        Geometry::NfpCache::generateKey(0, 180.0, false, 1, 0.0, false, false), shapeA, shapeB), loaded));
+    QVERIFY(!reader.find(Geometry::NfpDiskKey::fromKey(
+        Geometry::NfpCache::generateKey(0, 270.0, false, 1, 0.0, false, false), shapeA, shapeB), loaded));
+
+    // Segments written with another backend profile or at another scale are ignored.
+    Geometry::NfpDiskStore otherProfile(dir.path(), 2, scale);
+    QCOMPARE(otherProfile.segmentCount(), 0);
+    QVERIFY(!otherProfile.find(diskKey, loaded));
+    Geometry::NfpDiskStore otherScale(dir.path(), 1, 2 * scale);
+    QCOMPARE(otherScale.segmentCount(), 0);
+
+    // One segment per flush until there would be more than kMaxSegments; then they are merged
+    // into one and the merged files removed, every entry still found.
+    {
+        Geometry::NfpDiskStore writer(dir.path(), 1, scale);
+        for (int i = 1; i <= Geometry::NfpDiskStore::kMaxSegments; ++i) {
+            writer.record(Geometry::NfpDiskKey::fromKey(Geometry::NfpCache::generateKey(0, 0.0, false, 1, i, false, false),
+                                                        shapeA, shapeB),
+                          Geometry::NfpHandle(new Geometry::CachedNfp(Clipper2Lib::Paths64{nfpOuter})));
+            QVERIFY(writer.flush());
+            QVERIFY(writer.segmentCount() <= Geometry::NfpDiskStore::kMaxSegments);
+        }
+        QCOMPARE(writer.segmentCount(), 1);
+        QCOMPARE(QDir(dir.path()).entryList(QStringList() << QStringLiteral("*.seg"), QDir::Files).size(), 1);
+        QVERIFY(writer.find(diskKey, loaded));
+        QCOMPARE(loaded.pathCount(), 2);
+        for (int i = 1; i <= Geometry::NfpDiskStore::kMaxSegments; ++i) {
+            QVERIFY(writer.find(Geometry::NfpDiskKey::fromKey(Geometry::NfpCache::generateKey(0, 0.0, false, 1, i, false, false),
+                                                              shapeA, shapeB), loaded));
+            QVERIFY(loaded.toPaths() == Clipper2Lib::Paths64{nfpOuter});
+        }
+    }
+
+    // Past maxPendingBytes, record() writes the queue as a segment and lets go of its NFPs, so
+    // they are freed once the cache evicts them. The segment is mapped from the next flush() on.
+    {
+        QTemporaryDir spillDir;
+        QVERIFY(spillDir.isValid());
+        const Geometry::NfpDiskKey firstKey = Geometry::NfpDiskKey::fromKey(
+            Geometry::NfpCache::generateKey(0, 0.0, false, 1, 1, false, false), shapeA, shapeB);
+        const Geometry::NfpDiskKey secondKey = Geometry::NfpDiskKey::fromKey(
+            Geometry::NfpCache::generateKey(0, 0.0, false, 1, 2, false, false), shapeA, shapeB);
+        Geometry::NfpHandle nfp(new Geometry::CachedNfp(Clipper2Lib::Paths64{nfpOuter}));
+        QWeakPointer<const Geometry::CachedNfp> queued = nfp;
+        Geometry::NfpDiskStore writer(spillDir.path(), 1, scale, Geometry::NfpCache::entryCost(*nfp));
+        writer.record(firstKey, nfp);
+        nfp.reset();
+        QVERIFY(!queued.isNull()); // Within the limit, still queued
+        writer.record(secondKey, Geometry::NfpHandle(new Geometry::CachedNfp(Clipper2Lib::Paths64{nfpHole})));
+        QVERIFY(queued.isNull());
+        QCOMPARE(QDir(spillDir.path()).entryList(QStringList() << QStringLiteral("*.seg"), QDir::Files).size(), 1);
+        QVERIFY(writer.flush());
+        QCOMPARE(writer.segmentCount(), 1);
+        QVERIFY(writer.find(firstKey, loaded));
+        QVERIFY(loaded.toPaths() == Clipper2Lib::Paths64{nfpOuter});
+        QVERIFY(writer.find(secondKey, loaded));
+        QVERIFY(loaded.toPaths() == Clipper2Lib::Paths64{nfpHole});
+    }
+
+    // Without a directory the store is a no-op.
+    Geometry::NfpDiskStore disabled(QString(), 1, scale);
+    QVERIFY(!disabled.isEnabled());
+    QVERIFY(!disabled.find(diskKey, loaded));
+    QVERIFY(disabled.flush());
 }
 
 // QTEST_APPLESS_MAIN(TestSvgNest) // Or use a separate main_test.cpp
 // Note: SvgNest and potentially other components might require a QApplication instance.
-// If tests fail due to missing QApplication, a main_test.cpp with QApplication is needed.I have already created `DeepNestQt/tests/tests.pro` and `DeepNestQt/tests/tst_SvgNest.h` in the previous turns. I have also created `DeepNestQt/tests/tst_SvgNest.cpp` in the previous turn.
-
-Now, I will create `DeepNestQt/tests/main_test.cpp`.
+// If tests fail due to missing QApplication, a main_test.cpp with QApplication is needed.
@@ -41,8 +41,42 @@ private slots:
     void testGeometryUtilsArea_data();
     void testGeometryUtilsArea();
 
+    void testGeometryFingerprint_data();
+    void testGeometryFingerprint();
+
+    void testIsConvex_data();
+    void testIsConvex();
+    void testConvexMinkowskiSum_data();
+    void testConvexMinkowskiSum();
+    void testConvexDecomposition_data();
+    void testConvexDecomposition();
+    void testOrbitalNfp_data();
+    void testOrbitalNfp();
+    void testNfpRegions_data();
+    void testNfpRegions();
+    void testRectangleInnerNfp_data();
+    void testRectangleInnerNfp();
+    void testOffsetRegion_data();
+    void testOffsetRegion();
+    void testMinkowskiQuads_data();
+    void testMinkowskiQuads();
+    void testBatchPointInPolygon();
+    void testMinkowskiBatch();
+    void testMinkowskiAdaptiveScale();
+    void testOriginalModuleNfp_data();
+    void testOriginalModuleNfp();
+
     void testNfpCache_data();
     void testNfpCache();
+    void testNfpCacheEviction();
+    void testNfpStats();
+    void testNfpCacheSingleFlight();
+    void testNfpView();
+    void testNfpViewTranslation();
+    void testFeasibleRegion();
+    void testPlacementTrie();
+    void testObstacleUnion();
+    void testNfpDiskStore();
     
     // Placeholder for more complex tests
     // void testSimpleNestingRun(); // Integration-like test